@@ -0,0 +1,56 @@
+#include "ai_lod.h"
+
+#include <algorithm>
+#include <cmath>
+
+const uint64_t NEVER_UPDATED = ~0ull;
+
+void AiLodScheduler::resize(size_t playerCount) {
+    tier.assign(playerCount, 0);
+    depth.assign(playerCount, AI_LOD_TIERS[0].depth);
+    lastUpdate.assign(playerCount, NEVER_UPDATED);
+    priority.assign(playerCount, 0.0f);
+    dueList.clear();
+    dueList.reserve(playerCount);
+}
+
+void AiLodScheduler::schedule(const std::vector<Player>& players, const Ball& ball,
+                              const Frustum& frustum, uint64_t tick) {
+    dueList.clear();
+
+    for (size_t i = 0; i < players.size(); i++) {
+        const Player& player = players[i];
+        float dx = ball.position.x - player.position.x;
+        float dz = ball.position.z - player.position.z;
+        float distance = sqrtf(dx*dx + dz*dz);
+
+        uint32_t t = 0;
+        while (t + 1 < AI_LOD_TIER_COUNT && distance > AI_LOD_TIERS[t].maxBallDistance) {
+            t++;
+        }
+        if (!frustum.containsSphere(player.position.x, player.position.y, player.position.z, player.size)) {
+            t = std::min(t + 1, AI_LOD_TIER_COUNT - 1);
+        }
+        // The player under the user's finger always gets full-rate decisions
+        if (player.selected) {
+            t = 0;
+        }
+
+        tier[i] = static_cast<uint8_t>(t);
+        depth[i] = AI_LOD_TIERS[t].depth;
+
+        uint32_t interval = AI_LOD_TIERS[t].interval;
+        if (lastUpdate[i] == NEVER_UPDATED) {
+            priority[i] = 1.0e9f;
+            dueList.push_back(static_cast<uint16_t>(i));
+        } else if (tick - lastUpdate[i] >= interval) {
+            // How many intervals late the decision is, nearer tiers break ties
+            priority[i] = static_cast<float>(tick - lastUpdate[i]) / interval - t * 0.01f;
+            dueList.push_back(static_cast<uint16_t>(i));
+        }
+    }
+
+    std::sort(dueList.begin(), dueList.end(), [this](uint16_t a, uint16_t b) {
+        return priority[a] > priority[b];
+    });
+}
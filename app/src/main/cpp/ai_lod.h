@@ -0,0 +1,53 @@
+#pragma once
+
+#include "frustum.h"
+#include "simulation.h"
+
+#include <cstdint>
+#include <vector>
+
+// Decision rate and depth for one AI level of detail
+struct AiLodTier {
+    float maxBallDistance;   // Players within this distance of the ball use the tier
+    uint32_t interval;       // Ticks between decisions
+    uint8_t depth;           // Deepest behavior tree node evaluated
+};
+
+// Ordered from richest to cheapest; off-screen players drop one tier
+const AiLodTier AI_LOD_TIERS[] = {
+    {6.0f, 1, 255},
+    {14.0f, 2, 2},
+    {1.0e9f, 4, 1}
+};
+const uint32_t AI_LOD_TIER_COUNT = sizeof(AI_LOD_TIERS) / sizeof(AI_LOD_TIERS[0]);
+
+const float AI_DEFAULT_BUDGET_MICROS = 500.0f;
+
+// Assigns every player an AI tier from its distance to the ball and whether
+// the camera can see it, then lists the players due for a decision this tick,
+// most overdue first. Players skipped because the time budget ran out keep
+// their last decision and rise in priority next tick.
+class AiLodScheduler {
+public:
+    void resize(size_t playerCount);
+    void schedule(const std::vector<Player>& players, const Ball& ball, const Frustum& frustum, uint64_t tick);
+    void markUpdated(uint16_t player, uint64_t tick) { lastUpdate[player] = tick; }
+
+    const std::vector<uint16_t>& due() const { return dueList; }
+    const uint8_t* depthLimits() const { return depth.data(); }
+    uint8_t tierOf(uint16_t player) const { return tier[player]; }
+
+    float budgetMicros = AI_DEFAULT_BUDGET_MICROS;
+
+    // Per-tick counters
+    uint32_t updatedCount = 0;
+    uint32_t deferredCount = 0;
+    float spentMicros = 0.0f;
+
+private:
+    std::vector<uint8_t> tier;
+    std::vector<uint8_t> depth;
+    std::vector<uint64_t> lastUpdate;
+    std::vector<float> priority;
+    std::vector<uint16_t> dueList;
+};
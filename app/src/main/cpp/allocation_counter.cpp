@@ -0,0 +1,65 @@
+#include "allocation_counter.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+static thread_local uint64_t allocationCount = 0;
+
+uint64_t threadAllocationCount() {
+    return allocationCount;
+}
+
+#if FRAME_ALLOCATION_TRACKING
+
+static void* countedAllocate(size_t size, size_t alignment) {
+    allocationCount++;
+    if (size == 0) {
+        size = 1;
+    }
+    void* pointer = nullptr;
+    if (alignment <= alignof(std::max_align_t)) {
+        pointer = std::malloc(size);
+    } else {
+        // posix_memalign rather than aligned_alloc, which Android only has from API 28
+        if (posix_memalign(&pointer, alignment, size) != 0) {
+            pointer = nullptr;
+        }
+    }
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new(size_t size) { return countedAllocate(size, 0); }
+void* operator new[](size_t size) { return countedAllocate(size, 0); }
+void* operator new(size_t size, std::align_val_t alignment) { return countedAllocate(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return countedAllocate(size, static_cast<size_t>(alignment)); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return countedAllocate(size, 0);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return countedAllocate(size, 0);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+
+#endif
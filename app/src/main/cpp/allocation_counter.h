@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+// Debug heap allocation counting. Built with FRAME_ALLOCATION_TRACKING the
+// global operator new is replaced by one that counts calls per thread, so a
+// frame loop can check it allocates nothing once warmed up. Without it the
+// count stays at zero and nothing is replaced.
+#ifndef FRAME_ALLOCATION_TRACKING
+#define FRAME_ALLOCATION_TRACKING 0
+#endif
+
+// Heap allocations made by the calling thread so far
+uint64_t threadAllocationCount();
+
+// Counts the calling thread's allocations from construction to count()
+class AllocationScope {
+public:
+    AllocationScope() : start(threadAllocationCount()) {}
+
+    uint64_t count() const { return threadAllocationCount() - start; }
+
+private:
+    uint64_t start;
+};
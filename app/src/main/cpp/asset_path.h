@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdlib>
+#include <string>
+
+// Game data (behavior trees, formations) is read from one asset root rather
+// than the working directory: SOCCER_ASSET_DIR when set, otherwise the
+// ASSET_ROOT the build was configured with.
+#ifndef ASSET_ROOT
+#define ASSET_ROOT "assets"
+#endif
+
+const char* const ASSET_DIR_ENV = "SOCCER_ASSET_DIR";
+
+// Resolves a path relative to the asset root; absolute paths pass through
+inline std::string assetPath(const std::string& relative) {
+    if (!relative.empty() && relative[0] == '/') {
+        return relative;
+    }
+    const char* root = getenv(ASSET_DIR_ENV);
+    std::string path = (root && root[0]) ? root : ASSET_ROOT;
+    if (!path.empty() && path.back() != '/') {
+        path += '/';
+    }
+    return path + relative;
+}
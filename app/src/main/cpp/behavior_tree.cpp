@@ -0,0 +1,257 @@
+#include "behavior_tree.h"
+#include "asset_path.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+uint16_t BtRegistry::add(const std::string& name, BtLeafFn fn) {
+    if (find(name) >= 0) {
+        throw std::runtime_error("behavior tree leaf registered twice: " + name);
+    }
+    names.push_back(name);
+    leaves.push_back(fn);
+    return static_cast<uint16_t>(leaves.size() - 1);
+}
+
+int BtRegistry::find(const std::string& name) const {
+    for (size_t i = 0; i < names.size(); i++) {
+        if (names[i] == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+BehaviorTree BehaviorTree::compile(const std::string& source, const BtRegistry& registry) {
+    struct OpenNode {
+        uint32_t index;
+        int indent;
+        int children;
+    };
+
+    BehaviorTree tree;
+    std::vector<OpenNode> open;
+    std::istringstream stream(source);
+    std::string line;
+    int lineNumber = 0;
+
+    auto fail = [&](const std::string& message) {
+        throw std::runtime_error("behavior tree line " + std::to_string(lineNumber) + ": " + message);
+    };
+
+    while (std::getline(stream, line)) {
+        lineNumber++;
+
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+
+        int indent = 0;
+        size_t pos = 0;
+        while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t')) {
+            indent += (line[pos] == '\t') ? 4 : 1;
+            pos++;
+        }
+
+        std::istringstream tokens(line.substr(pos));
+        std::string keyword, name;
+        if (!(tokens >> keyword)) {
+            continue;
+        }
+        tokens >> name;
+
+        // Close every subtree that this line is not nested in
+        while (!open.empty() && indent <= open.back().indent) {
+            tree.code[open.back().index].next = static_cast<uint32_t>(tree.code.size());
+            open.pop_back();
+        }
+
+        if (open.empty() && !tree.code.empty()) {
+            fail("a behavior tree must have a single root");
+        }
+
+        if (!open.empty()) {
+            OpenNode& parent = open.back();
+            BtOp parentOp = tree.code[parent.index].op;
+            if (parentOp == BtOp::Condition || parentOp == BtOp::Action) {
+                fail("leaf nodes cannot have children");
+            }
+            if ((parentOp == BtOp::Inverter || parentOp == BtOp::Succeeder) && parent.children > 0) {
+                fail("decorators take exactly one child");
+            }
+            parent.children++;
+        }
+
+        BtInstruction instruction{};
+        instruction.depth = static_cast<uint8_t>(open.size());
+        if (open.size() >= 255) {
+            fail("tree is nested too deeply");
+        }
+
+        if (keyword == "sequence") {
+            instruction.op = BtOp::Sequence;
+        } else if (keyword == "selector") {
+            instruction.op = BtOp::Selector;
+        } else if (keyword == "invert") {
+            instruction.op = BtOp::Inverter;
+        } else if (keyword == "succeed") {
+            instruction.op = BtOp::Succeeder;
+        } else if (keyword == "condition" || keyword == "action") {
+            instruction.op = (keyword == "condition") ? BtOp::Condition : BtOp::Action;
+            int leaf = registry.find(name);
+            if (leaf < 0) {
+                fail("unknown leaf '" + name + "'");
+            }
+            instruction.leaf = static_cast<uint16_t>(leaf);
+        } else {
+            fail("unknown node '" + keyword + "'");
+        }
+
+        if (instruction.depth > tree.depth) {
+            tree.depth = instruction.depth;
+        }
+
+        open.push_back({static_cast<uint32_t>(tree.code.size()), indent, 0});
+        tree.code.push_back(instruction);
+    }
+
+    while (!open.empty()) {
+        tree.code[open.back().index].next = static_cast<uint32_t>(tree.code.size());
+        open.pop_back();
+    }
+
+    if (tree.code.empty()) {
+        throw std::runtime_error("behavior tree is empty!");
+    }
+
+    for (const BtInstruction& instruction : tree.code) {
+        if ((instruction.op == BtOp::Inverter || instruction.op == BtOp::Succeeder) &&
+            instruction.next == static_cast<uint32_t>(&instruction - tree.code.data()) + 1) {
+            throw std::runtime_error("behavior tree decorator without a child!");
+        }
+    }
+
+    // Resolve leaves once so evaluation never touches the registry
+    for (BtInstruction& instruction : tree.code) {
+        if (instruction.op == BtOp::Condition || instruction.op == BtOp::Action) {
+            tree.leaves.push_back(registry.get(instruction.leaf));
+            instruction.leaf = static_cast<uint16_t>(tree.leaves.size() - 1);
+        }
+    }
+
+    return tree;
+}
+
+BehaviorTree BehaviorTree::compileFile(const std::string& path, const BtRegistry& registry) {
+    std::string resolved = assetPath(path);
+    std::ifstream file(resolved);
+    if (!file) {
+        throw std::runtime_error("failed to open behavior tree " + resolved);
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return compile(buffer.str(), registry);
+}
+
+void BehaviorTree::evaluate(BtContext& ctx, const uint16_t* agents, uint32_t count) const {
+    if (count == 0) {
+        return;
+    }
+    // Grow contexts that were never reserved, or were reserved for fewer
+    // agents than the blackboard holds or for a shallower tree
+    uint32_t agentCapacity = std::max(ctx.agentCapacity, ctx.blackboard->agentCapacity());
+    if (ctx.agentCapacity < agentCapacity ||
+        ctx.scratch.size() < static_cast<size_t>(agentCapacity) * 2 * (depth + 1)) {
+        ctx.reserve(agentCapacity, depth);
+    }
+    evalNode(0, agents, count, ctx);
+}
+
+uint32_t BehaviorTree::filterByDepth(uint32_t child, const uint16_t* agents, uint32_t count,
+                                     uint16_t* eligible, BtContext& ctx) const {
+    uint8_t childDepth = code[child].depth;
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint16_t agent = agents[i];
+        if (ctx.depthLimit[agent] >= childDepth) {
+            eligible[kept++] = agent;
+        } else {
+            ctx.status[agent] = BT_FAILURE;
+        }
+    }
+    return kept;
+}
+
+void BehaviorTree::evalNode(uint32_t node, const uint16_t* agents, uint32_t count, BtContext& ctx) const {
+    const BtInstruction& instruction = code[node];
+    uint8_t* status = ctx.status.data();
+    uint16_t* eligible = ctx.list(instruction.depth, 1);
+
+    switch (instruction.op) {
+        case BtOp::Condition:
+        case BtOp::Action:
+            leaves[instruction.leaf](ctx.user, *ctx.blackboard, agents, count, status);
+            break;
+
+        case BtOp::Sequence:
+        case BtOp::Selector: {
+            // Agents that produce the "keep going" status move on to the next child
+            uint8_t keepGoing = (instruction.op == BtOp::Sequence) ? BT_SUCCESS : BT_FAILURE;
+            uint16_t* pending = ctx.list(instruction.depth, 0);
+            memcpy(pending, agents, count * sizeof(uint16_t));
+            uint32_t pendingCount = count;
+
+            for (uint32_t i = 0; i < count; i++) {
+                status[agents[i]] = keepGoing;
+            }
+
+            for (uint32_t child = node + 1; child < instruction.next && pendingCount > 0; child = code[child].next) {
+                const uint16_t* batch = pending;
+                uint32_t batchCount = pendingCount;
+                if (ctx.depthLimit) {
+                    batchCount = filterByDepth(child, pending, pendingCount, eligible, ctx);
+                    batch = eligible;
+                }
+                if (batchCount > 0) {
+                    evalNode(child, batch, batchCount, ctx);
+                }
+
+                uint32_t kept = 0;
+                for (uint32_t i = 0; i < pendingCount; i++) {
+                    if (status[pending[i]] == keepGoing) {
+                        pending[kept++] = pending[i];
+                    }
+                }
+                pendingCount = kept;
+            }
+            break;
+        }
+
+        case BtOp::Inverter:
+        case BtOp::Succeeder: {
+            const uint16_t* batch = agents;
+            uint32_t batchCount = count;
+            if (ctx.depthLimit) {
+                batchCount = filterByDepth(node + 1, agents, count, eligible, ctx);
+                batch = eligible;
+            }
+            if (batchCount == 0) {
+                break;
+            }
+            evalNode(node + 1, batch, batchCount, ctx);
+            for (uint32_t i = 0; i < batchCount; i++) {
+                uint8_t& s = status[batch[i]];
+                if (instruction.op == BtOp::Succeeder) {
+                    s = BT_SUCCESS;
+                } else if (s != BT_RUNNING) {
+                    s = (s == BT_SUCCESS) ? BT_FAILURE : BT_SUCCESS;
+                }
+            }
+            break;
+        }
+    }
+}
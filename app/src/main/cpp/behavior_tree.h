@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Behavior trees are authored as indented text (see assets/ai/*.bt) and
+// compiled at load time into a flat pre-order instruction array. Each
+// instruction stores the index one past its subtree, so the evaluator walks
+// children by index instead of chasing node pointers.
+//
+// Evaluation is batched: every agent that shares a tree is evaluated in one
+// pass, and each leaf is called once per batch with the list of agents that
+// reached it. Per-agent data lives in a structure-of-arrays Blackboard.
+
+enum BtStatus : uint8_t {
+    BT_FAILURE = 0,
+    BT_SUCCESS = 1,
+    BT_RUNNING = 2
+};
+
+enum class BtOp : uint8_t {
+    Sequence,
+    Selector,
+    Inverter,
+    Succeeder,
+    Condition,
+    Action
+};
+
+struct BtInstruction {
+    BtOp op;
+    uint8_t depth;
+    uint16_t leaf;   // Leaf table index for Condition/Action
+    uint32_t next;   // Index one past the end of this subtree
+};
+
+// Per-agent blackboard in SoA layout: slot s of agent a is values[s * capacity + a]
+class Blackboard {
+public:
+    void resize(uint32_t agentCount, uint32_t slotCount) {
+        capacity = agentCount;
+        slots = slotCount;
+        values.assign(static_cast<size_t>(agentCount) * slotCount, 0.0f);
+    }
+
+    float* slot(uint32_t s) { return values.data() + static_cast<size_t>(s) * capacity; }
+    const float* slot(uint32_t s) const { return values.data() + static_cast<size_t>(s) * capacity; }
+
+    uint32_t agentCapacity() const { return capacity; }
+    uint32_t slotCount() const { return slots; }
+
+private:
+    uint32_t capacity = 0;
+    uint32_t slots = 0;
+    std::vector<float> values;
+};
+
+// Leaves receive the agents that reached them and write one status per agent,
+// indexed by agent id.
+using BtLeafFn = void (*)(void* user, Blackboard& blackboard,
+                          const uint16_t* agents, uint32_t count, uint8_t* status);
+
+class BtRegistry {
+public:
+    uint16_t add(const std::string& name, BtLeafFn fn);
+    int find(const std::string& name) const;
+    BtLeafFn get(uint16_t index) const { return leaves[index]; }
+
+private:
+    std::vector<std::string> names;
+    std::vector<BtLeafFn> leaves;
+};
+
+// Scratch state for one batch evaluation; sized once and reused every tick
+struct BtContext {
+    Blackboard* blackboard = nullptr;
+    void* user = nullptr;
+    const uint8_t* depthLimit = nullptr;  // Optional per-agent decision depth
+    std::vector<uint8_t> status;      // Result per agent id
+    std::vector<uint16_t> scratch;    // Two agent lists per tree depth
+    uint32_t agentCapacity = 0;
+
+    void reserve(uint32_t agentCount, uint32_t maxDepth) {
+        agentCapacity = agentCount;
+        status.assign(agentCount, BT_FAILURE);
+        scratch.assign(static_cast<size_t>(agentCount) * 2 * (maxDepth + 1), 0);
+    }
+
+    uint16_t* list(uint32_t depth, uint32_t which) {
+        return scratch.data() + static_cast<size_t>(depth * 2 + which) * agentCapacity;
+    }
+};
+
+class BehaviorTree {
+public:
+    static BehaviorTree compile(const std::string& source, const BtRegistry& registry);
+    // path is relative to the asset root (see asset_path.h)
+    static BehaviorTree compileFile(const std::string& path, const BtRegistry& registry);
+
+    // Evaluates the tree for every listed agent; results land in ctx.status.
+    // Nodes deeper than an agent's ctx.depthLimit fail without being evaluated.
+    void evaluate(BtContext& ctx, const uint16_t* agents, uint32_t count) const;
+
+    const std::vector<BtInstruction>& instructions() const { return code; }
+    uint32_t maxDepth() const { return depth; }
+
+private:
+    void evalNode(uint32_t node, const uint16_t* agents, uint32_t count, BtContext& ctx) const;
+    uint32_t filterByDepth(uint32_t child, const uint16_t* agents, uint32_t count,
+                           uint16_t* eligible, BtContext& ctx) const;
+
+    std::vector<BtInstruction> code;
+    std::vector<BtLeafFn> leaves;     // Resolved at compile time, indexed by BtInstruction::leaf
+    uint32_t depth = 0;
+};
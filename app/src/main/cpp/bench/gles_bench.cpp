@@ -0,0 +1,251 @@
+// GLES2 game renderer on the desktop.
+//
+//   gles_bench [frames] [width height]
+//
+// Drives the Android GLES2 game (gles_game.cpp, as main.cpp does) from an
+// EGL pbuffer: Mesa's llvmpipe will do, headless with
+// EGL_PLATFORM=surfaceless. The match steps once per frame on a virtual
+// 60 Hz clock while a fixed touch script (tap, drag, swipe at the ball,
+// pinch out and back in) plays through the gesture recognizer, so every run
+// renders the same frames. Reports the CPU time of renderGame, of the
+// glFinish after it (the rendering itself on a software rasterizer), the
+// GL calls and draws per frame, and a checksum of the last frame.
+
+#include "../gles_game.h"
+#include "../frame_timing.h"
+#include "../gl_call_counter.h"
+
+#include <EGL/eglext.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+const uint32_t WARMUP_FRAMES = 30;   // Not timed: shader compilation and driver caches settle first
+const uint32_t SCRIPT_FRAMES = 240;  // The touch script repeats with this period
+
+enum TouchAction {
+    TOUCH_DOWN,
+    TOUCH_MOVE,
+    TOUCH_UP
+};
+
+// One pointer sample, in pitch units. fromBall samples are offsets from
+// where the ball was when the pointer went down.
+struct ScriptedTouch {
+    uint32_t frame;
+    TouchAction action;
+    int32_t pointer;
+    float x, y;
+    bool fromBall;
+};
+
+const ScriptedTouch TOUCH_SCRIPT[] = {
+    // Tap: the red player runs to it
+    {10, TOUCH_DOWN, 0, 2.0f, -3.0f, false},
+    {13, TOUCH_UP, 0, 2.0f, -3.0f, false},
+    // Drag the blue player across, hold still, release
+    {40, TOUCH_DOWN, 0, 0.0f, 5.5f, false},
+    {45, TOUCH_MOVE, 0, -0.5f, 5.0f, false},
+    {50, TOUCH_MOVE, 0, -1.0f, 4.2f, false},
+    {55, TOUCH_MOVE, 0, -1.8f, 3.5f, false},
+    {60, TOUCH_MOVE, 0, -2.5f, 2.8f, false},
+    {65, TOUCH_MOVE, 0, -3.0f, 2.0f, false},
+    {75, TOUCH_UP, 0, -3.0f, 2.0f, false},
+    // Swipe from the ball
+    {120, TOUCH_DOWN, 0, 0.0f, 0.0f, true},
+    {121, TOUCH_MOVE, 0, 0.4f, 0.3f, true},
+    {122, TOUCH_MOVE, 0, 0.8f, 0.6f, true},
+    {123, TOUCH_UP, 0, 1.2f, 0.9f, true},
+    // Pinch out
+    {160, TOUCH_DOWN, 0, -1.0f, 0.0f, false},
+    {160, TOUCH_DOWN, 1, 1.0f, 0.0f, false},
+    {165, TOUCH_MOVE, 0, -1.5f, 0.0f, false},
+    {165, TOUCH_MOVE, 1, 1.5f, 0.0f, false},
+    {170, TOUCH_MOVE, 0, -2.0f, 0.0f, false},
+    {170, TOUCH_MOVE, 1, 2.0f, 0.0f, false},
+    {175, TOUCH_UP, 1, 2.0f, 0.0f, false},
+    {175, TOUCH_UP, 0, -2.0f, 0.0f, false},
+    // And back in
+    {200, TOUCH_DOWN, 0, -2.0f, 0.0f, false},
+    {200, TOUCH_DOWN, 1, 2.0f, 0.0f, false},
+    {205, TOUCH_MOVE, 0, -1.5f, 0.0f, false},
+    {205, TOUCH_MOVE, 1, 1.5f, 0.0f, false},
+    {210, TOUCH_MOVE, 0, -1.0f, 0.0f, false},
+    {210, TOUCH_MOVE, 1, 1.0f, 0.0f, false},
+    {215, TOUCH_UP, 1, 1.0f, 0.0f, false},
+    {215, TOUCH_UP, 0, -1.0f, 0.0f, false},
+};
+
+// Surfaceless when Mesa offers it, so no display server is needed
+static EGLDisplay openDisplay() {
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (clientExtensions && strstr(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (getPlatformDisplay) {
+            EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            if (display != EGL_NO_DISPLAY) {
+                return display;
+            }
+        }
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+static bool createContext(GameState* state) {
+    state->display = openDisplay();
+    if (state->display == EGL_NO_DISPLAY || !eglInitialize(state->display, nullptr, nullptr)) {
+        fprintf(stderr, "failed to initialize EGL\n");
+        return false;
+    }
+    eglBindAPI(EGL_OPENGL_ES_API);
+
+    // The same config as on Android, on a pbuffer instead of a window
+    const EGLint attribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+        EGL_BLUE_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_RED_SIZE, 8,
+        EGL_DEPTH_SIZE, 16,
+        EGL_NONE
+    };
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_CLIENT_VERSION, 2,
+        EGL_NONE
+    };
+    const EGLint surfaceAttribs[] = {
+        EGL_WIDTH, state->width,
+        EGL_HEIGHT, state->height,
+        EGL_NONE
+    };
+
+    EGLint numConfigs = 0;
+    EGLConfig config;
+    if (!eglChooseConfig(state->display, attribs, &config, 1, &numConfigs) || numConfigs == 0) {
+        fprintf(stderr, "no EGL config for a GLES2 pbuffer\n");
+        return false;
+    }
+    state->surface = eglCreatePbufferSurface(state->display, config, surfaceAttribs);
+    state->context = eglCreateContext(state->display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (state->surface == EGL_NO_SURFACE || state->context == EGL_NO_CONTEXT ||
+        !eglMakeCurrent(state->display, state->surface, state->surface, state->context)) {
+        fprintf(stderr, "failed to create a GLES2 pbuffer context\n");
+        return false;
+    }
+    return true;
+}
+
+// Feeds the script's samples for this frame to the recognizer
+static void playScript(GameState* state, uint32_t frame, std::chrono::steady_clock::time_point time,
+                       float& ballX, float& ballY) {
+    uint32_t scriptFrame = frame % SCRIPT_FRAMES;
+    for (const ScriptedTouch& touch : TOUCH_SCRIPT) {
+        if (touch.frame != scriptFrame) {
+            continue;
+        }
+        if (touch.action == TOUCH_DOWN && touch.fromBall) {
+            ballX = state->ball.x;
+            ballY = state->ball.y;
+        }
+        float x = touch.fromBall ? ballX + touch.x : touch.x;
+        float y = touch.fromBall ? ballY + touch.y : touch.y;
+        switch (touch.action) {
+            case TOUCH_DOWN:
+                state->gestures.pointerDown(touch.pointer, x, y, time);
+                break;
+            case TOUCH_MOVE:
+                state->gestures.pointerMove(touch.pointer, x, y, time);
+                break;
+            case TOUCH_UP:
+                state->gestures.pointerUp(touch.pointer, x, y, time);
+                break;
+        }
+    }
+}
+
+// FNV-1a over the pixels, to tell whether a change altered the output
+static uint32_t frameChecksum(const GameState* state) {
+    std::vector<uint8_t> pixels(static_cast<size_t>(state->width) * state->height * 4);
+    glReadPixels(0, 0, state->width, state->height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    uint32_t hash = 2166136261u;
+    for (uint8_t byte : pixels) {
+        hash = (hash ^ byte) * 16777619u;
+    }
+    return hash;
+}
+
+int main(int argc, char** argv) {
+    uint32_t frames = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 0;
+    if (frames == 0) {
+        frames = 1200;
+    }
+
+    GameState state = {};
+    state.width = argc > 3 ? atoi(argv[2]) : 720;
+    state.height = argc > 3 ? atoi(argv[3]) : 1280;
+    if (!createContext(&state)) {
+        return EXIT_FAILURE;
+    }
+    if (!initRenderer(&state)) {
+        fprintf(stderr, "failed to create shader program\n");
+        return EXIT_FAILURE;
+    }
+    glViewport(0, 0, state.width, state.height);
+    initGame(&state);
+    publishMatchView(&state);
+
+    FrameTimeSeries renderTimes;
+    FrameTimeSeries finishTimes;
+    renderTimes.reserve(frames);
+    finishTimes.reserve(frames);
+    GlCallCounts counted;
+
+    // Virtual clock: frame n is n simulation steps after the start
+    std::chrono::steady_clock::time_point clock{};
+    float ballX = 0.0f, ballY = 0.0f;
+    for (uint32_t frame = 0; frame < WARMUP_FRAMES + frames; frame++) {
+        clock += SIM_STEP_INTERVAL;
+        playScript(&state, frame, clock, ballX, ballY);
+        flushGestures(&state);
+        updateGame(&state, clock);
+        publishMatchView(&state);
+
+        GlCallCounts before = glCallCounts;
+        auto start = std::chrono::steady_clock::now();
+        renderGame(&state);
+        auto rendered = std::chrono::steady_clock::now();
+        glFinish();
+        auto finished = std::chrono::steady_clock::now();
+        if (frame >= WARMUP_FRAMES) {
+            renderTimes.add(rendered - start);
+            finishTimes.add(finished - rendered);
+            counted.calls += glCallCounts.calls - before.calls;
+            counted.draws += glCallCounts.draws - before.draws;
+        }
+        if (frame + 1 < WARMUP_FRAMES + frames) {
+            eglSwapBuffers(state.display, state.surface);
+        }
+    }
+    uint32_t checksum = frameChecksum(&state);
+
+    std::cout << reinterpret_cast<const char*>(glGetString(GL_RENDERER)) << ", " << state.width << "x"
+              << state.height << ", " << frames << " frames" << std::endl;
+    renderTimes.print(std::cout, "cpu render");
+    finishTimes.print(std::cout, "glFinish");
+    if (GL_CALL_COUNTING) {
+        std::cout << "gl calls per frame: " << static_cast<double>(counted.calls) / frames
+                  << ", draws per frame: " << static_cast<double>(counted.draws) / frames << std::endl;
+    }
+    printf("last frame checksum: %08x\n", checksum);
+
+    shutdownGame(&state);
+    eglMakeCurrent(state.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(state.display, state.context);
+    eglDestroySurface(state.display, state.surface);
+    eglTerminate(state.display);
+    return EXIT_SUCCESS;
+}
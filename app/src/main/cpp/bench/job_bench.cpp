@@ -0,0 +1,106 @@
+// Job system overhead and scaling.
+//
+//   job_bench [max_workers]
+//
+// Overhead: empty jobs started from the main thread and waited on, and
+// empty parallelFor ranges. Scaling: match rollouts (the planner's unit of
+// work) spread with parallelFor over 1..max_workers workers plus the
+// calling thread, against a plain loop.
+
+#include "../job_system.h"
+#include "../simulation.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static volatile float sink;
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static MatchSnapshot kickoffSnapshot() {
+    MatchSnapshot snapshot{};
+    snapshot.playerCount = MAX_PLAYERS;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        int team = i / PLAYERS_PER_TEAM;
+        int slot = i % PLAYERS_PER_TEAM;
+        float x = (team == 0 ? -FIELD_WIDTH/4 : FIELD_WIDTH/4);
+        float z = (slot - PLAYERS_PER_TEAM/2) * 2.0f;
+        snapshot.players[i] = {{x, PLAYER_SIZE/2, z}, {0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f, 1.0f},
+                               team, PLAYER_SIZE, false};
+    }
+    snapshot.ball = kickoffBall();
+    return snapshot;
+}
+
+// One second of play from the snapshot with a kick that depends on i
+static float rollout(const MatchSnapshot& start, uint32_t i) {
+    MatchSnapshot snapshot = start;
+    snapshot.ball.velocity = {(i % 17) * 0.5f - 4.0f, 0.0f, (i % 13) * 0.5f - 3.0f};
+    for (int step = 0; step < 60; step++) {
+        stepMatch(snapshot, 1.0f / 60.0f);
+    }
+    return snapshot.ball.position.x + snapshot.ball.position.z;
+}
+
+int main(int argc, char** argv) {
+    CpuTopology topology = detectCpuTopology();
+    unsigned maxWorkers = argc > 1 ? static_cast<unsigned>(atoi(argv[1])) : 0;
+    if (maxWorkers == 0) {
+        size_t cores = topology.jobCores.empty() ? topology.logicalCores : topology.jobCores.size();
+        maxWorkers = cores > 1 ? static_cast<unsigned>(cores) - 1 : 1;
+    }
+    printf("%u logical cores, %zu job cores%s\n", topology.logicalCores, topology.jobCores.size(),
+           topology.heterogeneous ? " (heterogeneous, slowest tier excluded)" : "");
+
+    {
+        JobSystem jobs(maxWorkers);
+        const uint32_t jobCount = 200000;
+        auto start = std::chrono::steady_clock::now();
+        JobCounter counter;
+        for (uint32_t i = 0; i < jobCount; i++) {
+            jobs.run([] {}, &counter);
+        }
+        jobs.wait(counter);
+        printf("empty job, run + wait: %.0f ns/job (%u workers)\n", secondsSince(start) * 1.0e9 / jobCount,
+               jobs.workerCount());
+
+        const uint32_t ranges = 1000;
+        const int repeats = 200;
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; r++) {
+            jobs.parallelFor(ranges, 1, [](uint32_t, uint32_t) {});
+        }
+        printf("empty parallelFor range: %.0f ns/range\n", secondsSince(start) * 1.0e9 / (ranges * repeats));
+    }
+
+    const MatchSnapshot snapshot = kickoffSnapshot();
+    const uint32_t rollouts = 4096;
+    const uint32_t grain = 16;
+    std::vector<float> results(rollouts);
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < rollouts; i++) {
+        results[i] = rollout(snapshot, i);
+    }
+    double serial = secondsSince(start);
+    sink = results[rollouts - 1];
+    printf("rollouts, plain loop: %.2f ms\n", serial * 1000.0);
+
+    for (unsigned workers = 1; workers <= maxWorkers; workers++) {
+        JobSystem jobs(workers);
+        start = std::chrono::steady_clock::now();
+        jobs.parallelFor(rollouts, grain, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                results[i] = rollout(snapshot, i);
+            }
+        });
+        double elapsed = secondsSince(start);
+        sink = results[rollouts - 1];
+        printf("rollouts, %u workers + caller: %.2f ms, %.2fx\n", workers, elapsed * 1000.0, serial / elapsed);
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+// Microbenchmark for simd_math.h against the scalar helpers it replaced.
+//
+//   math_bench [objects]
+
+#include "../simd_math.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// The triple-loop product the engine used before simd_math.h
+static Mat4 legacyMultiply(const Mat4& a, const Mat4& b) {
+    Mat4 mat = {};
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            for (int k = 0; k < 4; k++) {
+                mat.m[i*4 + j] += a.m[i*4 + k] * b.m[k*4 + j];
+            }
+        }
+    }
+    return mat;
+}
+
+static volatile float sink;
+
+template <typename Fn>
+static double nsPerItem(size_t items, int repeats, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        fn();
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / (static_cast<double>(items) * repeats);
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 10000;
+    const int repeats = 200;
+
+    std::vector<float> x(n), y(n), z(n), s(n);
+    for (size_t i = 0; i < n; i++) {
+        x[i] = (i % 97) * 0.1f;
+        y[i] = 0.25f;
+        z[i] = (i % 89) * -0.1f;
+        s[i] = 0.5f + (i % 7) * 0.01f;
+    }
+    std::vector<Mat4> out(n);
+
+    Mat4 viewProj = mat4Multiply(mat4Perspective(radians(45.0f), 1.5f, 0.1f, 100.0f),
+                                 mat4LookAt({0.0f, 15.0f, 25.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}));
+
+    // Model matrices already in memory, as when drawing a scene
+    std::vector<Mat4> models(n);
+    for (size_t i = 0; i < n; i++) {
+        models[i] = mat4Multiply(mat4Translate(x[i], y[i], z[i]), mat4Scale(s[i], s[i], s[i]));
+    }
+
+    double legacy = nsPerItem(n, repeats, [&] {
+        for (size_t i = 0; i < n; i++) {
+            out[i] = legacyMultiply(models[i], viewProj);
+        }
+        sink = out[n - 1].m[12];
+    });
+    double single = nsPerItem(n, repeats, [&] {
+        mat4MultiplyBatch(viewProj, models.data(), out.data(), n);
+        sink = out[n - 1].m[12];
+    });
+    double build = nsPerItem(n, repeats, [&] {
+        mat4TranslateScaleBatch(x.data(), y.data(), z.data(), s.data(), out.data(), n);
+        sink = out[n - 1].m[12];
+    });
+    double batch = nsPerItem(n, repeats, [&] {
+        mat4TransformTranslateScaleBatch(viewProj, x.data(), y.data(), z.data(), s.data(), out.data(), n);
+        sink = out[n - 1].m[12];
+    });
+
+    // The batch must agree with the composed single products
+    float maxError = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        Mat4 reference = mat4Multiply(viewProj, mat4Multiply(mat4Translate(x[i], y[i], z[i]), mat4Scale(s[i], s[i], s[i])));
+        for (int k = 0; k < 16; k++) {
+            maxError = std::max(maxError, std::fabs(reference.m[k] - out[i].m[k]));
+        }
+    }
+
+    printf("backend: %s, %zu objects\n", simdMathBackend(), n);
+    printf("legacy triple-loop view-proj * model: %8.2f ns/object\n", legacy);
+    printf("mat4MultiplyBatch view-proj * model:  %8.2f ns/object\n", single);
+    printf("mat4TranslateScaleBatch model build:  %8.2f ns/object\n", build);
+    printf("mat4TransformTranslateScaleBatch:     %8.2f ns/object\n", batch);
+    printf("max batch error: %g\n", maxError);
+    return 0;
+}
@@ -0,0 +1,48 @@
+// Measures Monte Carlo planner throughput on a kickoff snapshot.
+//
+//   planner_bench [budget_ms] [workers]
+
+#include "../job_system.h"
+#include "../planner.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+static MatchSnapshot kickoffSnapshot() {
+    MatchSnapshot snapshot{};
+    snapshot.playerCount = MAX_PLAYERS;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        int team = i / PLAYERS_PER_TEAM;
+        int slot = i % PLAYERS_PER_TEAM;
+        float x = (team == 0 ? -FIELD_WIDTH/4 : FIELD_WIDTH/4);
+        float z = (slot - PLAYERS_PER_TEAM/2) * 2.0f;
+        snapshot.players[i] = {{x, PLAYER_SIZE/2, z}, {0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f, 1.0f},
+                               team, PLAYER_SIZE, false};
+    }
+    snapshot.ball = kickoffBall();
+    return snapshot;
+}
+
+int main(int argc, char** argv) {
+    float budgetMs = argc > 1 ? static_cast<float>(atof(argv[1])) : 50.0f;
+    unsigned workers = argc > 2 ? static_cast<unsigned>(atoi(argv[2])) : 0;
+
+    JobSystem jobs(workers);
+    MonteCarloPlanner planner(jobs);
+    MatchSnapshot snapshot = kickoffSnapshot();
+
+    const int runs = 10;
+    double totalRate = 0.0;
+    for (int run = 0; run < runs; run++) {
+        auto candidates = MonteCarloPlanner::kickFan(run % 2, 8, 10.0f);
+        int best = planner.plan(snapshot, run % 2, candidates, budgetMs * 1000.0f);
+        totalRate += planner.rolloutsPerSecond();
+        printf("run %d: %llu rollouts in %.2f ms, best candidate %d (score %.3f)\n",
+               run, (unsigned long long)planner.lastRollouts, planner.lastElapsedMicros / 1000.0f,
+               best, best >= 0 ? candidates[best].score : 0.0f);
+    }
+
+    printf("rollouts/second: %.0f (%.1f s horizon at %.0f Hz)\n",
+           totalRate / runs, planner.horizonSeconds, 1.0f / planner.stepSeconds);
+    return 0;
+}
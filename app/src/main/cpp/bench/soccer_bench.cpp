@@ -0,0 +1,254 @@
+// Simulation step throughput, per phase.
+//
+//   soccer_bench [ticks] [output.json]
+//
+// Runs the match step (the physics half of the engine's updatePhysics) with
+// scripted players over three scenarios: 11v11, 5v5 and a 1000-player
+// stress field. Each scenario is run twice from the same start: once
+// through stepMatch for ticks/second, once phase by phase for ns/tick per
+// phase (integration, goal check, ball-player and player-player collisions)
+// and heap allocations per tick. Results go to output.json, or stdout, so a
+// change can be diffed against a baseline run. The step must not allocate:
+// if any tick after the first ALLOCATION_WARMUP_TICKS does, the exit status
+// is non-zero.
+
+#include "../allocation_counter.h"
+#include "../simulation.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// One tick of the engine's fixed step
+const float TICK = 1.0f / 60.0f;
+
+// Ticks whose allocations are counted but do not fail the run
+const uint32_t ALLOCATION_WARMUP_TICKS = 10;
+
+// Every CHASER_STRIDE-th player runs for the ball; the rest hold a spot
+const size_t CHASER_STRIDE = 4;
+
+static volatile float sink;
+
+struct Scenario {
+    const char* name;
+    size_t playersPerTeam;
+};
+
+enum Phase {
+    PHASE_INTEGRATION,
+    PHASE_BALL,
+    PHASE_GOAL_CHECK,
+    PHASE_BALL_PLAYER,
+    PHASE_PLAYER_PLAYER,
+    PHASE_COUNT
+};
+
+static const char* const PHASE_NAMES[PHASE_COUNT] = {
+    "integration", "ball", "goal_check", "ball_player_collision", "player_player_collision"
+};
+
+struct Result {
+    const char* name;
+    size_t players;
+    double ticksPerSecond;
+    double nsPerTick;
+    double phaseNsPerTick[PHASE_COUNT];
+    double allocationsPerTick;
+    uint32_t allocatingTicks;   // After warm-up
+    uint32_t goals;
+};
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Two teams in rows across their own halves, kickoff ball
+static void lineUp(size_t playersPerTeam, std::vector<Player>& players, std::vector<Vec3>& homes, Ball& ball) {
+    size_t columns = static_cast<size_t>(std::ceil(std::sqrt(static_cast<float>(playersPerTeam) * 2.0f)));
+    size_t rows = (playersPerTeam + columns - 1) / columns;
+    float spacingX = (FIELD_WIDTH - 2.0f * PLAYER_SIZE) / static_cast<float>(columns);
+    float spacingZ = (FIELD_HEIGHT/2 - 2.0f * PLAYER_SIZE) / static_cast<float>(rows);
+
+    players.clear();
+    homes.clear();
+    for (size_t i = 0; i < 2 * playersPerTeam; i++) {
+        int team = static_cast<int>(i / playersPerTeam);
+        size_t slot = i % playersPerTeam;
+        float x = -FIELD_WIDTH/2 + PLAYER_SIZE + (static_cast<float>(slot % columns) + 0.5f) * spacingX;
+        float depth = PLAYER_SIZE + (static_cast<float>(slot / columns) + 0.5f) * spacingZ;
+        Vec3 home = {x, PLAYER_SIZE/2, team == 0 ? -depth : depth};
+        players.push_back({home, {0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f, 1.0f}, team, PLAYER_SIZE, false});
+        homes.push_back(home);
+    }
+    ball = kickoffBall();
+}
+
+// Stand-in for the AI: chasers run at the ball, everyone else circles their
+// home spot, so the collision phases see realistic contact
+static void steer(std::vector<Player>& players, const std::vector<Vec3>& homes, const Ball& ball, uint32_t tick) {
+    float time = static_cast<float>(tick) * TICK;
+    for (size_t i = 0; i < players.size(); i++) {
+        Player& player = players[i];
+        Vec3 target = homes[i];
+        if (i % CHASER_STRIDE == 0) {
+            target = ball.position;
+        } else {
+            target.x += std::sin(time + static_cast<float>(i)) * 1.5f;
+            target.z += std::cos(time * 0.7f + static_cast<float>(i)) * 1.5f;
+        }
+        float dx = target.x - player.position.x;
+        float dz = target.z - player.position.z;
+        float distance = std::sqrt(dx*dx + dz*dz);
+        float speed = std::min(PLAYER_SPEED, distance * 4.0f);
+        player.velocity = distance > 0.01f ? Vec3{dx / distance * speed, 0.0f, dz / distance * speed}
+                                           : Vec3{0.0f, 0.0f, 0.0f};
+    }
+}
+
+static Result run(const Scenario& scenario, uint32_t ticks) {
+    Result result{};
+    result.name = scenario.name;
+    result.players = 2 * scenario.playersPerTeam;
+
+    std::vector<Player> players;
+    std::vector<Vec3> homes;
+    Ball ball{};
+
+    // Whole steps: steering is timed too, it is what keeps the ball moving,
+    // and measured once on its own below to take it back out
+    lineUp(scenario.playersPerTeam, players, homes, ball);
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t tick = 0; tick < ticks; tick++) {
+        steer(players, homes, ball, tick);
+        stepMatch(players.data(), players.size(), ball, TICK);
+    }
+    double stepSeconds = secondsSince(start);
+    sink = ball.position.x;
+
+    lineUp(scenario.playersPerTeam, players, homes, ball);
+    start = std::chrono::steady_clock::now();
+    for (uint32_t tick = 0; tick < ticks; tick++) {
+        steer(players, homes, ball, tick);
+    }
+    double steerSeconds = secondsSince(start);
+    sink = players[0].velocity.x;
+
+    double seconds = std::max(stepSeconds - steerSeconds, 1e-9);
+    result.ticksPerSecond = ticks / seconds;
+    result.nsPerTick = seconds * 1e9 / ticks;
+
+    // Phase by phase, in stepMatch's order
+    lineUp(scenario.playersPerTeam, players, homes, ball);
+    std::chrono::steady_clock::duration phaseTime[PHASE_COUNT] = {};
+    uint64_t allocations = 0;
+    uint32_t warmupTicks = std::min(ALLOCATION_WARMUP_TICKS, ticks / 2);   // Short stress runs are checked too
+    for (uint32_t tick = 0; tick < ticks; tick++) {
+        steer(players, homes, ball, tick);
+        StepEvents events;
+
+        AllocationScope scope;
+        auto t0 = std::chrono::steady_clock::now();
+        integratePlayers(players.data(), players.size(), TICK);
+        auto t1 = std::chrono::steady_clock::now();
+        bool hitEndLine = integrateBall(ball, TICK);
+        auto t2 = std::chrono::steady_clock::now();
+        checkGoal(ball, hitEndLine, &events);
+        auto t3 = std::chrono::steady_clock::now();
+        collideBallWithPlayers(players.data(), players.size(), ball);
+        auto t4 = std::chrono::steady_clock::now();
+        separatePlayers(players.data(), players.size());
+        auto t5 = std::chrono::steady_clock::now();
+        uint64_t tickAllocations = scope.count();
+        allocations += tickAllocations;
+        if (tickAllocations > 0 && tick >= warmupTicks) {
+            result.allocatingTicks++;
+        }
+
+        phaseTime[PHASE_INTEGRATION] += t1 - t0;
+        phaseTime[PHASE_BALL] += t2 - t1;
+        phaseTime[PHASE_GOAL_CHECK] += t3 - t2;
+        phaseTime[PHASE_BALL_PLAYER] += t4 - t3;
+        phaseTime[PHASE_PLAYER_PLAYER] += t5 - t4;
+        if (events.goalSide != 0) {
+            result.goals++;
+        }
+    }
+    sink = ball.position.z;
+
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        result.phaseNsPerTick[phase] = std::chrono::duration<double, std::nano>(phaseTime[phase]).count() / ticks;
+    }
+    result.allocationsPerTick = static_cast<double>(allocations) / ticks;
+    return result;
+}
+
+// Cost of one steady_clock::now(), included in every phase figure
+static double clockNs() {
+    const int reads = 1000000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reads; i++) {
+        sink = static_cast<float>(std::chrono::steady_clock::now().time_since_epoch().count());
+    }
+    return secondsSince(start) * 1e9 / reads;
+}
+
+int main(int argc, char** argv) {
+    uint32_t ticks = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 0;
+    if (ticks == 0) {
+        ticks = 20000;
+    }
+    FILE* out = stdout;
+    if (argc > 2) {
+        out = fopen(argv[2], "w");
+        if (!out) {
+            fprintf(stderr, "cannot open %s\n", argv[2]);
+            return 1;
+        }
+    }
+    if (!FRAME_ALLOCATION_TRACKING) {
+        fprintf(stderr, "built without FRAME_ALLOCATION_TRACKING: allocation counts read 0\n");
+    }
+
+    const Scenario scenarios[] = {
+        {"11v11", PLAYERS_PER_TEAM},
+        {"5v5", 5},
+        {"stress_1000", 500},
+    };
+
+    fprintf(out, "{\n  \"ticks\": %u,\n  \"tick_seconds\": %.6f,\n  \"clock_read_ns\": %.1f,\n  \"scenarios\": [\n",
+            ticks, TICK, clockNs());
+    size_t count = sizeof(scenarios) / sizeof(scenarios[0]);
+    bool failed = false;
+    for (size_t s = 0; s < count; s++) {
+        // The O(n^2) stress case gets fewer ticks; its per-tick figures are
+        // still comparable
+        uint32_t scenarioTicks = scenarios[s].playersPerTeam > PLAYERS_PER_TEAM ? std::max(ticks / 100, 10u) : ticks;
+        Result result = run(scenarios[s], scenarioTicks);
+
+        fprintf(out, "    {\n      \"name\": \"%s\",\n      \"players\": %zu,\n      \"ticks\": %u,\n",
+                result.name, result.players, scenarioTicks);
+        fprintf(out, "      \"ticks_per_second\": %.1f,\n      \"ns_per_tick\": %.1f,\n",
+                result.ticksPerSecond, result.nsPerTick);
+        fprintf(out, "      \"phase_ns_per_tick\": {");
+        for (int phase = 0; phase < PHASE_COUNT; phase++) {
+            fprintf(out, "%s\"%s\": %.1f", phase ? ", " : "", PHASE_NAMES[phase], result.phaseNsPerTick[phase]);
+        }
+        fprintf(out, "},\n      \"allocations_per_tick\": %.3f,\n      \"allocating_ticks\": %u,\n"
+                "      \"goals\": %u\n    }%s\n",
+                result.allocationsPerTick, result.allocatingTicks, result.goals, s + 1 < count ? "," : "");
+        if (result.allocatingTicks > 0) {
+            fprintf(stderr, "%s: %u ticks allocated on the heap after warm-up\n", result.name, result.allocatingTicks);
+            failed = true;
+        }
+    }
+    fprintf(out, "  ]\n}\n");
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,298 @@
+// Behavior tree compiler and batched evaluator.
+//
+//   behavior_tree_check
+//
+// Compiles assets/ai/field_player.bt through the asset root and checks the
+// instruction layout, then evaluates batches of agents against scripted
+// leaves: which action each agent reaches, that every leaf runs once per
+// batch, decorators, RUNNING propagation, per-agent depth limits, contexts
+// that evaluate() has to grow, and the compile errors.
+
+#include "check.h"
+#include "../behavior_tree.h"
+
+#include <cstring>
+#include <stdexcept>
+
+// Slots read by the scripted conditions and written by the actions
+enum CheckSlot : uint32_t {
+    SLOT_USER,
+    SLOT_CLOSEST,
+    SLOT_NEAR,
+    SLOT_ACTION,
+    SLOT_COUNT
+};
+
+enum CheckAction {
+    ACTION_NONE,
+    ACTION_IDLE,
+    ACTION_CHASE,
+    ACTION_SUPPORT,
+    ACTION_HOLD
+};
+
+enum CheckLeaf {
+    LEAF_USER,
+    LEAF_CLOSEST,
+    LEAF_NEAR,
+    LEAF_IDLE,
+    LEAF_CHASE,
+    LEAF_SUPPORT,
+    LEAF_HOLD,
+    LEAF_COUNT
+};
+
+struct LeafCalls {
+    uint32_t calls[LEAF_COUNT];
+    uint32_t agents[LEAF_COUNT];
+};
+
+static void record(void* user, CheckLeaf leaf, uint32_t count) {
+    LeafCalls* calls = static_cast<LeafCalls*>(user);
+    calls->calls[leaf]++;
+    calls->agents[leaf] += count;
+}
+
+static void condition(Blackboard& bb, uint32_t slot, const uint16_t* agents, uint32_t count, uint8_t* status) {
+    for (uint32_t i = 0; i < count; i++) {
+        status[agents[i]] = bb.slot(slot)[agents[i]] != 0.0f ? BT_SUCCESS : BT_FAILURE;
+    }
+}
+
+static void action(Blackboard& bb, CheckAction id, uint8_t result, const uint16_t* agents, uint32_t count,
+                   uint8_t* status) {
+    for (uint32_t i = 0; i < count; i++) {
+        bb.slot(SLOT_ACTION)[agents[i]] = static_cast<float>(id);
+        status[agents[i]] = result;
+    }
+}
+
+static void isUserControlled(void* user, Blackboard& bb, const uint16_t* agents, uint32_t count, uint8_t* status) {
+    record(user, LEAF_USER, count);
+    condition(bb, SLOT_USER, agents, count, status);
+}
+
+static void isClosestToBall(void* user, Blackboard& bb, const uint16_t* agents, uint32_t count, uint8_t* status) {
+    record(user, LEAF_CLOSEST, count);
+    condition(bb, SLOT_CLOSEST, agents, count, status);
+}
+
+static void isBallNear(void* user, Blackboard& bb, const uint16_t* agents, uint32_t count, uint8_t* status) {
+    record(user, LEAF_NEAR, count);
+    condition(bb, SLOT_NEAR, agents, count, status);
+}
+
+static void idle(void* user, Blackboard& bb, const uint16_t* agents, uint32_t count, uint8_t* status) {
+    record(user, LEAF_IDLE, count);
+    action(bb, ACTION_IDLE, BT_SUCCESS, agents, count, status);
+}
+
+// Chasing takes several ticks
+static void chaseBall(void* user, Blackboard& bb, const uint16_t* agents, uint32_t count, uint8_t* status) {
+    record(user, LEAF_CHASE, count);
+    action(bb, ACTION_CHASE, BT_RUNNING, agents, count, status);
+}
+
+// Fails, so a selector moves on to its next child
+static void supportBall(void* user, Blackboard& bb, const uint16_t* agents, uint32_t count, uint8_t* status) {
+    record(user, LEAF_SUPPORT, count);
+    action(bb, ACTION_SUPPORT, BT_FAILURE, agents, count, status);
+}
+
+static void holdPosition(void* user, Blackboard& bb, const uint16_t* agents, uint32_t count, uint8_t* status) {
+    record(user, LEAF_HOLD, count);
+    action(bb, ACTION_HOLD, BT_SUCCESS, agents, count, status);
+}
+
+static BtRegistry checkRegistry() {
+    BtRegistry registry;
+    registry.add("isUserControlled", isUserControlled);
+    registry.add("isClosestToBall", isClosestToBall);
+    registry.add("isBallNear", isBallNear);
+    registry.add("idle", idle);
+    registry.add("chaseBall", chaseBall);
+    registry.add("supportBall", supportBall);
+    registry.add("holdPosition", holdPosition);
+    return registry;
+}
+
+struct Agents {
+    Blackboard blackboard;
+    BtContext context;
+    LeafCalls calls;
+
+    Agents(uint32_t count, const BehaviorTree& tree) {
+        blackboard.resize(count, SLOT_COUNT);
+        context.blackboard = &blackboard;
+        context.user = &calls;
+        context.reserve(count, tree.maxDepth());
+        memset(&calls, 0, sizeof(calls));
+    }
+
+    void set(uint16_t agent, bool user, bool closest, bool ballNear) {
+        blackboard.slot(SLOT_USER)[agent] = user ? 1.0f : 0.0f;
+        blackboard.slot(SLOT_CLOSEST)[agent] = closest ? 1.0f : 0.0f;
+        blackboard.slot(SLOT_NEAR)[agent] = ballNear ? 1.0f : 0.0f;
+    }
+
+    int actionOf(uint16_t agent) const { return static_cast<int>(blackboard.slot(SLOT_ACTION)[agent]); }
+};
+
+static void checkFieldPlayerLayout(const BehaviorTree& tree) {
+    // selector
+    //     sequence: isUserControlled, idle
+    //     sequence: isClosestToBall, chaseBall
+    //     sequence: isBallNear, supportBall
+    //     holdPosition
+    const BtOp ops[] = {
+        BtOp::Selector,
+        BtOp::Sequence, BtOp::Condition, BtOp::Action,
+        BtOp::Sequence, BtOp::Condition, BtOp::Action,
+        BtOp::Sequence, BtOp::Condition, BtOp::Action,
+        BtOp::Action
+    };
+    const uint8_t depths[] = {0, 1, 2, 2, 1, 2, 2, 1, 2, 2, 1};
+    const uint32_t next[] = {11, 4, 3, 4, 7, 6, 7, 10, 9, 10, 11};
+
+    const std::vector<BtInstruction>& code = tree.instructions();
+    CHECK(code.size() == 11);
+    CHECK(tree.maxDepth() == 2);
+    if (code.size() != 11) {
+        return;
+    }
+    for (size_t i = 0; i < code.size(); i++) {
+        CHECK(code[i].op == ops[i]);
+        CHECK(code[i].depth == depths[i]);
+        CHECK(code[i].next == next[i]);
+    }
+}
+
+static void checkFieldPlayerBatch(const BehaviorTree& tree) {
+    Agents agents(6, tree);
+    agents.set(0, true, true, true);     // User control wins over everything
+    agents.set(1, false, true, true);    // Closest chases
+    agents.set(2, false, false, true);   // Supports, which fails, so holds
+    agents.set(3, false, false, false);  // Holds
+    agents.set(4, false, true, false);   // Not in the batch
+
+    const uint16_t batch[] = {0, 1, 2, 3};
+    tree.evaluate(agents.context, batch, 4);
+
+    CHECK(agents.actionOf(0) == ACTION_IDLE);
+    CHECK(agents.actionOf(1) == ACTION_CHASE);
+    CHECK(agents.actionOf(2) == ACTION_HOLD);
+    CHECK(agents.actionOf(3) == ACTION_HOLD);
+    CHECK(agents.actionOf(4) == ACTION_NONE);
+    CHECK(agents.context.status[0] == BT_SUCCESS);
+    CHECK(agents.context.status[1] == BT_RUNNING);
+    CHECK(agents.context.status[2] == BT_SUCCESS);
+    CHECK(agents.context.status[3] == BT_SUCCESS);
+
+    // Each leaf runs once for the agents that reached it
+    const uint32_t calls[LEAF_COUNT] = {1, 1, 1, 1, 1, 1, 1};
+    const uint32_t reached[LEAF_COUNT] = {4, 3, 2, 1, 1, 1, 2};
+    for (int leaf = 0; leaf < LEAF_COUNT; leaf++) {
+        CHECK(agents.calls.calls[leaf] == calls[leaf]);
+        CHECK(agents.calls.agents[leaf] == reached[leaf]);
+    }
+}
+
+static void checkDepthLimits(const BehaviorTree& tree) {
+    Agents agents(2, tree);
+    agents.set(0, true, true, true);
+    agents.set(1, true, true, true);
+
+    // Agent 1 only evaluates the root's children: every sequence fails
+    // without running its leaves and it falls through to holdPosition
+    const uint8_t limits[] = {255, 1};
+    agents.context.depthLimit = limits;
+    const uint16_t batch[] = {0, 1};
+    tree.evaluate(agents.context, batch, 2);
+
+    CHECK(agents.actionOf(0) == ACTION_IDLE);
+    CHECK(agents.actionOf(1) == ACTION_HOLD);
+    CHECK(agents.calls.agents[LEAF_USER] == 1);
+    CHECK(agents.calls.agents[LEAF_HOLD] == 1);
+}
+
+// evaluate() grows contexts that were never reserved, or were reserved for
+// fewer agents or a shallower tree, before using them
+static void checkUnreservedContexts(const BehaviorTree& tree) {
+    for (uint32_t reserved = 0; reserved < 3; reserved++) {
+        Agents agents(6, tree);
+        agents.context = BtContext();
+        agents.context.blackboard = &agents.blackboard;
+        agents.context.user = &agents.calls;
+        if (reserved == 1) {
+            agents.context.reserve(2, tree.maxDepth());
+        } else if (reserved == 2) {
+            agents.context.reserve(6, 0);
+        }
+        agents.set(1, false, true, true);
+        agents.set(5, true, false, false);
+
+        const uint16_t batch[] = {1, 3, 5};
+        tree.evaluate(agents.context, batch, 3);
+
+        CHECK(agents.context.agentCapacity >= 6);
+        CHECK(agents.context.status.size() >= 6);
+        CHECK(agents.actionOf(1) == ACTION_CHASE);
+        CHECK(agents.actionOf(3) == ACTION_HOLD);
+        CHECK(agents.actionOf(5) == ACTION_IDLE);
+        CHECK(agents.context.status[1] == BT_RUNNING);
+        CHECK(agents.context.status[3] == BT_SUCCESS);
+        CHECK(agents.context.status[5] == BT_SUCCESS);
+    }
+}
+
+static void checkDecorators(const BtRegistry& registry) {
+    BehaviorTree tree = BehaviorTree::compile(
+        "sequence\n"
+        "    invert\n"
+        "        condition isUserControlled\n"
+        "    succeed\n"
+        "        action supportBall   # fails, succeed turns it into success\n"
+        "    invert\n"
+        "        action chaseBall     # RUNNING passes through an inverter\n",
+        registry);
+    CHECK(tree.instructions().size() == 7);
+    CHECK(tree.maxDepth() == 2);
+
+    Agents agents(2, tree);
+    agents.set(0, true, false, false);
+    agents.set(1, false, false, false);
+    const uint16_t batch[] = {0, 1};
+    tree.evaluate(agents.context, batch, 2);
+
+    CHECK(agents.context.status[0] == BT_FAILURE);
+    CHECK(agents.actionOf(0) == ACTION_NONE);
+    CHECK(agents.context.status[1] == BT_RUNNING);
+    CHECK(agents.actionOf(1) == ACTION_CHASE);
+}
+
+static void checkCompileErrors(const BtRegistry& registry) {
+    CHECK_THROWS(BehaviorTree::compile("", registry));
+    CHECK_THROWS(BehaviorTree::compile("# only a comment\n", registry));
+    CHECK_THROWS(BehaviorTree::compile("action unknownLeaf\n", registry));
+    CHECK_THROWS(BehaviorTree::compile("repeat\n    action idle\n", registry));
+    CHECK_THROWS(BehaviorTree::compile("action idle\naction idle\n", registry));
+    CHECK_THROWS(BehaviorTree::compile("action idle\n    action idle\n", registry));
+    CHECK_THROWS(BehaviorTree::compile("invert\n    action idle\n    action idle\n", registry));
+    CHECK_THROWS(BehaviorTree::compile("sequence\n    invert\n", registry));
+    CHECK_THROWS(BehaviorTree::compileFile("ai/missing.bt", registry));
+}
+
+int main() {
+    BtRegistry registry = checkRegistry();
+    CHECK_THROWS(registry.add("idle", idle));
+
+    BehaviorTree fieldPlayer = BehaviorTree::compileFile("ai/field_player.bt", registry);
+    checkFieldPlayerLayout(fieldPlayer);
+    checkFieldPlayerBatch(fieldPlayer);
+    checkDepthLimits(fieldPlayer);
+    checkUnreservedContexts(fieldPlayer);
+    checkDecorators(registry);
+    checkCompileErrors(registry);
+
+    return checkResult("behavior_tree_check");
+}
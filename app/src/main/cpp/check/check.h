@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+
+// Host checks, run by ctest. Unlike assert, CHECK stays on in release
+// builds; failures are reported and turn into a non-zero exit status.
+inline int checkFailures = 0;
+
+inline void checkFailed(const char* file, int line, const char* what) {
+    fprintf(stderr, "%s:%d: %s\n", file, line, what);
+    checkFailures++;
+}
+
+#define CHECK(condition) \
+    ((condition) ? (void)0 : checkFailed(__FILE__, __LINE__, "CHECK(" #condition ") failed"))
+
+// The expression must throw a std::exception
+#define CHECK_THROWS(expression) \
+    do { \
+        bool thrown = false; \
+        try { \
+            (void)(expression); \
+        } catch (const std::exception&) { \
+            thrown = true; \
+        } \
+        if (!thrown) { \
+            checkFailed(__FILE__, __LINE__, #expression " did not throw"); \
+        } \
+    } while (0)
+
+// Exit status for main
+inline int checkResult(const char* name) {
+    if (checkFailures > 0) {
+        fprintf(stderr, "%s: %d check(s) failed\n", name, checkFailures);
+        return EXIT_FAILURE;
+    }
+    printf("%s: all checks passed\n", name);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,181 @@
+// Formations and the incremental auction solver.
+//
+//   formation_check
+//
+// Loads assets/formations/formations.txt through the asset root, then checks
+// the auction solver against brute force on random benefit matrices, its
+// warm start (no bids when nothing changed, an optimal assignment again
+// after drift) and a team lined up at kick-off keeping its own slots.
+
+#include "check.h"
+#include "../formation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <vector>
+
+const int BRUTE_FORCE_SIZE = 7;   // 5040 permutations
+const int RANDOM_MATRICES = 50;
+
+static uint32_t rngState = 12345;
+
+static float random01() {
+    rngState = rngState * 1664525u + 1013904223u;
+    return static_cast<float>(rngState >> 8) / static_cast<float>(1u << 24);
+}
+
+static float assignmentBenefit(const AuctionAssigner& assigner, const std::vector<float>& benefit, int n) {
+    float total = 0.0f;
+    for (int i = 0; i < n; i++) {
+        total += benefit[i * n + assigner.objectOf(i)];
+    }
+    return total;
+}
+
+static bool isPermutation(const AuctionAssigner& assigner, int n) {
+    std::vector<bool> taken(n, false);
+    for (int i = 0; i < n; i++) {
+        int j = assigner.objectOf(i);
+        if (j < 0 || j >= n || taken[j]) {
+            return false;
+        }
+        taken[j] = true;
+    }
+    return true;
+}
+
+static float bestBenefit(const std::vector<float>& benefit, int n) {
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    float best = -INFINITY;
+    do {
+        float total = 0.0f;
+        for (int i = 0; i < n; i++) {
+            total += benefit[i * n + order[i]];
+        }
+        best = std::max(best, total);
+    } while (std::next_permutation(order.begin(), order.end()));
+    return best;
+}
+
+static void checkLoadFormations() {
+    std::vector<Formation> formations = loadFormations("formations/formations.txt");
+    CHECK(formations.size() >= 2);
+    for (const Formation& formation : formations) {
+        CHECK(formation.slots.size() == PLAYERS_PER_TEAM);
+        for (const FormationSlot& slot : formation.slots) {
+            CHECK(slot.across >= -1.0f && slot.across <= 1.0f);
+            CHECK(slot.depth >= 0.0f && slot.depth < 0.5f);
+            CHECK(slot.mobility >= 0.0f && slot.mobility <= 1.0f);
+        }
+    }
+    CHECK(findFormation(formations, "4-4-2").slots[0].role == "GK");
+    CHECK(findFormation(formations, "4-3-3").name == "4-3-3");
+    CHECK_THROWS(findFormation(formations, "2-3-5"));
+    CHECK_THROWS(loadFormations("formations/missing.txt"));
+
+    // A formation one slot short
+    std::filesystem::path shortFile = std::filesystem::temp_directory_path() / "formation_check_short.txt";
+    {
+        std::ofstream file(shortFile);
+        file << "formation short\n";
+        for (int i = 0; i < PLAYERS_PER_TEAM - 1; i++) {
+            file << "    CM 0.0 0.3 1.0\n";
+        }
+    }
+    CHECK_THROWS(loadFormations(shortFile.string()));
+    std::filesystem::remove(shortFile);
+}
+
+static void checkAgainstBruteForce() {
+    int n = BRUTE_FORCE_SIZE;
+    std::vector<float> benefit(static_cast<size_t>(n) * n);
+    for (int run = 0; run < RANDOM_MATRICES; run++) {
+        for (float& value : benefit) {
+            value = random01() * 10.0f;
+        }
+        AuctionAssigner assigner;
+        assigner.resize(n);
+        assigner.solve(benefit.data());
+
+        // Auction with step epsilon is within n * epsilon of the optimum
+        CHECK(isPermutation(assigner, n));
+        CHECK(assignmentBenefit(assigner, benefit, n) >= bestBenefit(benefit, n) - n * assigner.epsilon - 1e-4f);
+    }
+}
+
+static void checkWarmStart() {
+    int n = PLAYERS_PER_TEAM;
+    std::vector<float> benefit(static_cast<size_t>(n) * n);
+    for (float& value : benefit) {
+        value = -random01() * 100.0f;
+    }
+    AuctionAssigner assigner;
+    assigner.resize(n);
+    assigner.solve(benefit.data());
+    CHECK(isPermutation(assigner, n));
+    CHECK(assigner.lastBids >= static_cast<uint32_t>(n));
+
+    // Unchanged benefits keep every assignment without a bid
+    std::vector<int> before(n);
+    for (int i = 0; i < n; i++) {
+        before[i] = assigner.objectOf(i);
+    }
+    assigner.solve(benefit.data());
+    CHECK(assigner.lastBids == 0);
+    for (int i = 0; i < n; i++) {
+        CHECK(assigner.objectOf(i) == before[i]);
+    }
+
+    // After a large change only the affected persons re-bid, and the result
+    // is still a full assignment
+    int moved = before[0];
+    for (int i = 0; i < n; i++) {
+        benefit[i * n + moved] -= 1000.0f;
+    }
+    assigner.solve(benefit.data());
+    CHECK(isPermutation(assigner, n));
+    CHECK(assigner.lastBids > 0);
+}
+
+static void checkKickoffShape() {
+    std::vector<Formation> formations = loadFormations("formations/formations.txt");
+    const char* names[2] = {"4-4-2", "4-3-3"};
+    TeamShape shapes[2];
+    std::vector<Player> players(MAX_PLAYERS);
+    for (int team = 0; team < 2; team++) {
+        shapes[team].init(findFormation(formations, names[team]), team, team * PLAYERS_PER_TEAM);
+        for (int k = 0; k < PLAYERS_PER_TEAM; k++) {
+            Vec2 spot = shapes[team].kickoffPosition(k);
+            Player& player = players[team * PLAYERS_PER_TEAM + k];
+            player = {};
+            player.position = {spot.x, PLAYER_SIZE/2, spot.y};
+            player.team = team;
+            // Each team kicks off from its own half
+            CHECK(spot.y * attackDirection(team) < 0.0f);
+        }
+    }
+
+    // With the ball on the centre spot every player keeps its own slot
+    Ball ball = kickoffBall();
+    for (int team = 0; team < 2; team++) {
+        shapes[team].update(players.data(), ball);
+        for (int k = 0; k < PLAYERS_PER_TEAM; k++) {
+            Vec2 home = shapes[team].homeOf(k);
+            Vec2 spot = shapes[team].kickoffPosition(k);
+            CHECK(std::fabs(home.x - spot.x) < 1e-4f && std::fabs(home.y - spot.y) < 1e-4f);
+        }
+    }
+}
+
+int main() {
+    checkLoadFormations();
+    checkAgainstBruteForce();
+    checkWarmStart();
+    checkKickoffShape();
+    return checkResult("formation_check");
+}
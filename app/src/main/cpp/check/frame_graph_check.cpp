@@ -0,0 +1,194 @@
+// Frame graph compilation.
+//
+//   frame_graph_check
+//
+// Compiles two frame graphs without a device and checks what the frame
+// graph derives. The first has a scene, a post-process pass reading the
+// scene colour as an input attachment and writing the swapchain, and a
+// debug pass nothing reads. Checked: the culled pass, the two subpasses of
+// one render pass, load and store ops, layouts, transient attachments and
+// the subpass dependencies. The second is a chain of passes that sample the
+// previous pass's output, checked for its split render passes and for the
+// offsets and barriers planAliasing gives its intermediate images.
+
+#include "check.h"
+#include "../frame_graph.h"
+
+#include <vector>
+
+const VkPipelineStageFlags COLOR_STAGE = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+const VkPipelineStageFlags DEPTH_STAGES = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                                          VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+
+static bool sameDependency(const VkSubpassDependency& dependency, uint32_t src, uint32_t dst,
+                           VkPipelineStageFlags srcStages, VkAccessFlags srcAccess,
+                           VkPipelineStageFlags dstStages, VkAccessFlags dstAccess, VkDependencyFlags flags) {
+    return dependency.srcSubpass == src && dependency.dstSubpass == dst &&
+           dependency.srcStageMask == srcStages && dependency.srcAccessMask == srcAccess &&
+           dependency.dstStageMask == dstStages && dependency.dstAccessMask == dstAccess &&
+           dependency.dependencyFlags == flags;
+}
+
+static void checkSceneToPresent() {
+    FrameGraph graph;
+    uint32_t sceneColor = graph.addAttachment({VK_FORMAT_R16G16B16A16_SFLOAT, false, true, false,
+                                               VK_IMAGE_LAYOUT_UNDEFINED});
+    uint32_t depth = graph.addAttachment({VK_FORMAT_D32_SFLOAT, true, true, false, VK_IMAGE_LAYOUT_UNDEFINED});
+    uint32_t backbuffer = graph.addAttachment({VK_FORMAT_B8G8R8A8_SRGB, false, false, true,
+                                               VK_IMAGE_LAYOUT_PRESENT_SRC_KHR});
+    uint32_t debugImage = graph.addAttachment({VK_FORMAT_R8G8B8A8_UNORM, false, true, false,
+                                               VK_IMAGE_LAYOUT_UNDEFINED});
+
+    FrameGraphPass scene;
+    scene.name = "scene";
+    scene.colorOutputs = {sceneColor};
+    scene.depthOutput = static_cast<int32_t>(depth);
+    uint32_t scenePass = graph.addPass(std::move(scene));
+
+    FrameGraphPass debug;
+    debug.name = "debug";
+    debug.colorOutputs = {debugImage};
+    uint32_t debugPass = graph.addPass(std::move(debug));
+
+    FrameGraphPass post;
+    post.name = "post";
+    post.inputs = {sceneColor};
+    post.colorOutputs = {backbuffer};
+    uint32_t postPass = graph.addPass(std::move(post));
+
+    graph.compile();
+
+    CHECK(!graph.isCulled(scenePass));
+    CHECK(graph.isCulled(debugPass));
+    CHECK(!graph.isCulled(postPass));
+
+    // The scene colour only lives in the render pass; the swapchain outlives it
+    CHECK(graph.isTransient(sceneColor));
+    CHECK(graph.isTransient(depth));
+    CHECK(!graph.isTransient(backbuffer));
+    CHECK(!graph.isTransient(debugImage));
+
+    // Scene and post-process are subpasses of one render pass
+    const FrameGraphRenderPass& info = graph.renderPassInfo(scenePass);
+    CHECK(&info == &graph.renderPassInfo(postPass));
+    CHECK((info.graphAttachments == std::vector<uint32_t>{sceneColor, depth, backbuffer}));
+    CHECK(info.subpasses.size() == 2);
+    if (info.attachments.size() != 3 || info.subpasses.size() != 2) {
+        CHECK(info.attachments.size() == 3);
+        return;
+    }
+
+    const VkAttachmentDescription& color = info.attachments[0];
+    CHECK(color.loadOp == VK_ATTACHMENT_LOAD_OP_CLEAR);
+    CHECK(color.storeOp == VK_ATTACHMENT_STORE_OP_DONT_CARE);
+    CHECK(color.initialLayout == VK_IMAGE_LAYOUT_UNDEFINED);
+    CHECK(color.finalLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    const VkAttachmentDescription& depthDescription = info.attachments[1];
+    CHECK(depthDescription.loadOp == VK_ATTACHMENT_LOAD_OP_CLEAR);
+    CHECK(depthDescription.storeOp == VK_ATTACHMENT_STORE_OP_DONT_CARE);
+    CHECK(depthDescription.finalLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+
+    // Post-processing covers every pixel, so the old contents are not loaded
+    const VkAttachmentDescription& present = info.attachments[2];
+    CHECK(present.loadOp == VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+    CHECK(present.storeOp == VK_ATTACHMENT_STORE_OP_STORE);
+    CHECK(present.initialLayout == VK_IMAGE_LAYOUT_UNDEFINED);
+    CHECK(present.finalLayout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+    const VkSubpassDescription& first = info.subpasses[0];
+    CHECK(first.colorAttachmentCount == 1 && first.pColorAttachments[0].attachment == 0);
+    CHECK(first.pColorAttachments[0].layout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    CHECK(first.pDepthStencilAttachment && first.pDepthStencilAttachment->attachment == 1);
+    CHECK(first.inputAttachmentCount == 0);
+
+    const VkSubpassDescription& second = info.subpasses[1];
+    CHECK(second.inputAttachmentCount == 1 && second.pInputAttachments[0].attachment == 0);
+    CHECK(second.pInputAttachments[0].layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    CHECK(second.colorAttachmentCount == 1 && second.pColorAttachments[0].attachment == 2);
+    CHECK(second.pDepthStencilAttachment == nullptr);
+    CHECK(second.preserveAttachmentCount == 0);
+
+    // First uses wait on earlier work, the input read on the scene write
+    CHECK(info.dependencies.size() == 3);
+    if (info.dependencies.size() == 3) {
+        CHECK(sameDependency(info.dependencies[0], VK_SUBPASS_EXTERNAL, 0,
+                             COLOR_STAGE | DEPTH_STAGES, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                             COLOR_STAGE | DEPTH_STAGES,
+                             VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, 0));
+        CHECK(sameDependency(info.dependencies[1], 0, 1,
+                             COLOR_STAGE, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_INPUT_ATTACHMENT_READ_BIT,
+                             VK_DEPENDENCY_BY_REGION_BIT));
+        CHECK(sameDependency(info.dependencies[2], VK_SUBPASS_EXTERNAL, 1,
+                             COLOR_STAGE, 0, COLOR_STAGE, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, 0));
+    }
+}
+
+static void checkSampledChainAliasing() {
+    const FrameGraphAttachment intermediate = {VK_FORMAT_R16G16B16A16_SFLOAT, false, true, false,
+                                               VK_IMAGE_LAYOUT_UNDEFINED};
+    FrameGraph graph;
+    uint32_t sceneColor = graph.addAttachment(intermediate);
+    uint32_t bright = graph.addAttachment(intermediate);
+    uint32_t blurred = graph.addAttachment(intermediate);
+    uint32_t backbuffer = graph.addAttachment({VK_FORMAT_B8G8R8A8_SRGB, false, false, true,
+                                               VK_IMAGE_LAYOUT_PRESENT_SRC_KHR});
+
+    // Each pass samples the previous one's output, which splits the render pass
+    const uint32_t chain[] = {sceneColor, bright, blurred, backbuffer};
+    uint32_t passes[4];
+    for (int i = 0; i < 4; i++) {
+        FrameGraphPass pass;
+        pass.colorOutputs = {chain[i]};
+        if (i > 0) {
+            pass.sampled = {chain[i - 1]};
+        }
+        passes[i] = graph.addPass(std::move(pass));
+    }
+    graph.compile();
+
+    for (int i = 0; i < 4; i++) {
+        CHECK(!graph.isCulled(passes[i]));
+        CHECK((graph.framebufferAttachments(passes[i]) == std::vector<uint32_t>{chain[i]}));
+    }
+    CHECK(&graph.renderPassInfo(passes[0]) != &graph.renderPassInfo(passes[1]));
+
+    // Sampled later, so stored and not transient
+    const VkAttachmentDescription& scene = graph.renderPassInfo(passes[0]).attachments[0];
+    CHECK(scene.loadOp == VK_ATTACHMENT_LOAD_OP_CLEAR);
+    CHECK(scene.storeOp == VK_ATTACHMENT_STORE_OP_STORE);
+    CHECK(!graph.isTransient(sceneColor));
+    CHECK(!graph.isTransient(bright));
+
+    // Without aliasing the blurred image's first write only waits for colour writes
+    const VkSubpassDependency& before = graph.renderPassInfo(passes[2]).dependencies[0];
+    CHECK(sameDependency(before, VK_SUBPASS_EXTERNAL, 0, COLOR_STAGE, 0,
+                         COLOR_STAGE, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, 0));
+
+    // Lifetimes in steps: scene 0-1, bright 1-2, blurred 2-3. Largest first:
+    // scene at 0, bright overlaps it in time and goes after it, blurred
+    // shares the scene's memory
+    std::vector<VkMemoryRequirements> requirements = {
+        {1000, 256, 1},
+        {500, 256, 1},
+        {400, 256, 1},
+    };
+    std::vector<VkDeviceSize> offsets;
+    VkDeviceSize size = graph.planAliasing({sceneColor, bright, blurred}, requirements, offsets);
+    CHECK((offsets == std::vector<VkDeviceSize>{0, 1024, 0}));
+    CHECK(size == 1524);
+
+    // Reusing the scene's memory, the blurred image's first write waits for
+    // any attachment write before it
+    const VkSubpassDependency& after = graph.renderPassInfo(passes[2]).dependencies[0];
+    CHECK(sameDependency(after, VK_SUBPASS_EXTERNAL, 0, COLOR_STAGE | DEPTH_STAGES,
+                         VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                         COLOR_STAGE, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, 0));
+}
+
+int main() {
+    checkSceneToPresent();
+    checkSampledChainAliasing();
+    return checkResult("frame_graph_check");
+}
@@ -0,0 +1,97 @@
+#include "culling.h"
+
+#include "job_system.h"
+
+#include <algorithm>
+
+// Padding lanes get a hugely negative radius so they never pass a plane test
+const float CULL_PADDING_RADIUS = -1.0e30f;
+
+// Objects per job when culling in parallel, a multiple of four. Below this a
+// job costs more than the tests it saves.
+const uint32_t CULL_JOB_GRAIN = 2048;
+
+void FrustumCuller::resize(size_t objectCount) {
+    count = objectCount;
+    size_t padded = (objectCount + 3) & ~size_t(3);
+    centerX.assign(padded, 0.0f);
+    centerY.assign(padded, 0.0f);
+    centerZ.assign(padded, 0.0f);
+    radius.assign(padded, CULL_PADDING_RADIUS);
+    visibleList.clear();
+    visibleList.reserve(objectCount);
+}
+
+void FrustumCuller::cull(const Frustum& frustum, JobSystem* jobs) {
+    visibleList.clear();
+    size_t padded = centerX.size();
+
+    if (!jobs || padded <= CULL_JOB_GRAIN) {
+        cullRange(frustum, 0, padded, visibleList);
+    } else {
+        uint32_t ranges = static_cast<uint32_t>((padded + CULL_JOB_GRAIN - 1) / CULL_JOB_GRAIN);
+        rangeVisible.resize(ranges);
+        jobs->parallelFor(ranges, 1, [&](uint32_t first, uint32_t last) {
+            for (uint32_t r = first; r < last; r++) {
+                rangeVisible[r].clear();
+                size_t begin = static_cast<size_t>(r) * CULL_JOB_GRAIN;
+                cullRange(frustum, begin, std::min(begin + CULL_JOB_GRAIN, padded), rangeVisible[r]);
+            }
+        });
+        for (const auto& range : rangeVisible) {
+            visibleList.insert(visibleList.end(), range.begin(), range.end());
+        }
+    }
+
+    drawnCount = static_cast<uint32_t>(visibleList.size());
+    culledCount = static_cast<uint32_t>(count) - drawnCount;
+}
+
+void FrustumCuller::cullRange(const Frustum& frustum, size_t begin, size_t end, std::vector<uint32_t>& out) const {
+    for (size_t i = begin; i < end; i += 4) {
+        // A sphere is visible unless it lies entirely behind one plane:
+        // a*x + b*y + c*z + d >= -radius for all six planes
+        uint32_t inside = 0;
+#if SIMD_MATH_SSE
+        __m128 x = _mm_loadu_ps(&centerX[i]);
+        __m128 y = _mm_loadu_ps(&centerY[i]);
+        __m128 z = _mm_loadu_ps(&centerZ[i]);
+        __m128 negR = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&radius[i]));
+        __m128 mask = _mm_setzero_ps();
+        for (int k = 0; k < 6; k++) {
+            const Plane& p = frustum.planes[k];
+            __m128 d = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(p.a)), _mm_set1_ps(p.d));
+            d = _mm_add_ps(d, _mm_mul_ps(y, _mm_set1_ps(p.b)));
+            d = _mm_add_ps(d, _mm_mul_ps(z, _mm_set1_ps(p.c)));
+            __m128 pass = _mm_cmpge_ps(d, negR);
+            mask = k == 0 ? pass : _mm_and_ps(mask, pass);
+        }
+        inside = static_cast<uint32_t>(_mm_movemask_ps(mask));
+#elif SIMD_MATH_NEON
+        float32x4_t x = vld1q_f32(&centerX[i]);
+        float32x4_t y = vld1q_f32(&centerY[i]);
+        float32x4_t z = vld1q_f32(&centerZ[i]);
+        float32x4_t negR = vnegq_f32(vld1q_f32(&radius[i]));
+        uint32x4_t mask = vdupq_n_u32(~0u);
+        for (const Plane& p : frustum.planes) {
+            float32x4_t d = vmlaq_n_f32(vdupq_n_f32(p.d), x, p.a);
+            d = vmlaq_n_f32(d, y, p.b);
+            d = vmlaq_n_f32(d, z, p.c);
+            mask = vandq_u32(mask, vcgeq_f32(d, negR));
+        }
+        inside = (vgetq_lane_u32(mask, 0) & 1) | (vgetq_lane_u32(mask, 1) & 2) |
+                 (vgetq_lane_u32(mask, 2) & 4) | (vgetq_lane_u32(mask, 3) & 8);
+#else
+        for (size_t lane = 0; lane < 4; lane++) {
+            if (frustum.containsSphere(centerX[i + lane], centerY[i + lane], centerZ[i + lane], radius[i + lane])) {
+                inside |= 1u << lane;
+            }
+        }
+#endif
+        for (uint32_t lane = 0; inside != 0; lane++, inside >>= 1) {
+            if ((inside & 1) && i + lane < count) {
+                out.push_back(static_cast<uint32_t>(i + lane));
+            }
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "frustum.h"
+#include "simd_math.h"
+
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+// CPU frustum culling over bounding spheres. Spheres are stored as separate
+// x/y/z/radius arrays padded to a multiple of four, so each plane test covers
+// four objects per SIMD instruction. cull() rebuilds the list of visible
+// object indices that the instanced draw walks; given a job system, large
+// sets are split into ranges culled in parallel.
+class FrustumCuller {
+public:
+    void resize(size_t objectCount);
+    size_t size() const { return count; }
+
+    void setSphere(uint32_t object, float x, float y, float z, float r) {
+        centerX[object] = x;
+        centerY[object] = y;
+        centerZ[object] = z;
+        radius[object] = r;
+    }
+
+    void cull(const Frustum& frustum, JobSystem* jobs = nullptr);
+
+    const std::vector<uint32_t>& visible() const { return visibleList; }
+
+    // Counters from the last cull() call, reported by the headless benchmark.
+    // GpuCuller counts on the GPU and has no CPU-side equivalent.
+    uint32_t drawnCount = 0;
+    uint32_t culledCount = 0;
+
+private:
+    // Appends the visible objects of [begin, end), both multiples of four
+    void cullRange(const Frustum& frustum, size_t begin, size_t end, std::vector<uint32_t>& out) const;
+
+    size_t count = 0;
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> radius;
+    std::vector<uint32_t> visibleList;
+    std::vector<std::vector<uint32_t>> rangeVisible;   // Per job range, merged in order
+};
@@ -1,6 +1,3 @@
-I'll create a complete Vulkan-based soccer game engine with physics and touch controls. This is a substantial implementation that handles all rendering programmatically.
-
-
 #include <vulkan/vulkan.h>
 #include <GLFW/glfw3.h>
 #include <vector>
@@ -10,33 +7,72 @@ I'll create a complete Vulkan-based soccer game engine with physics and touch co
 #include <iostream>
 #include <algorithm>
 #include <chrono>
-#include <random>
+#include <cstdlib>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "allocation_counter.h"
+#include "culling.h"
+#include "formation.h"
+#include "frame_arena.h"
+#include "frame_graph.h"
+#include "frame_timing.h"
+#include "gpu_culling.h"
+#include "job_system.h"
+#include "latency.h"
+#include "meshes.h"
+#include "pipeline_variants.h"
+#include "picking.h"
+#include "planner.h"
+#include "player_ai.h"
+#include "prediction.h"
+#include "simd_math.h"
+#include "simulation.h"
+#include "spatial_grid.h"
+#include "spsc_queue.h"
+#include "triple_buffer.h"
 
 // Constants
 const uint32_t WINDOW_WIDTH = 1200;
 const uint32_t WINDOW_HEIGHT = 800;
 const int MAX_FRAMES_IN_FLIGHT = 2;
+const char* const BEHAVIOR_TREE_PATH = "ai/field_player.bt";
+const char* const FORMATIONS_PATH = "formations/formations.txt";
+const char* const HOME_FORMATION = "4-4-2";
+const char* const AWAY_FORMATION = "4-3-3";
+const int KICKOFF_CANDIDATES = 8;
+const float KICKOFF_SPEED = 10.0f;
+const float KICKOFF_BUDGET_MICROS = 2000.0f;
+const uint32_t GPU_CULL_MAX_INSTANCES = 4096;
+const char* const GPU_CULLING_ENV = "SOCCER_GPU_CULLING";
+const std::chrono::microseconds SIM_STEP_INTERVAL{8333};   // Simulation thread rate, ~120 Hz
+const char* const DEBUG_VIEW_ENV = "SOCCER_DEBUG_VIEW";   // "lod" tints meshes by level of detail
+const size_t FRAME_ARENA_CAPACITY = 256 * 1024;   // Grows to the high-water mark if a frame needs more
+const uint64_t ALLOCATION_WARMUP_FRAMES = 120;   // Frames before heap allocations are reported (headless: fail the run)
+const size_t INPUT_QUEUE_CAPACITY = 256;   // Input events between two simulation steps
+const float PLAYER_PICK_RADIUS = 2.0f;     // How far from a player a press still selects it
+const char* const LATENCY_ENV = "SOCCER_LATENCY";   // Measure input-to-photon latency, report on exit
+const size_t APPLIED_INPUT_QUEUE_CAPACITY = 64;
+const size_t PRESENT_WAIT_QUEUE_CAPACITY = 32;      // Timed frames between the render and present-wait threads
+const uint64_t PRESENT_WAIT_TIMEOUT_NS = 100000000;  // A frame not shown within 100 ms is dropped
+const char* const HEADLESS_ENV = "SOCCER_HEADLESS";   // Frame count: render offscreen, report frame timings, exit
+const uint64_t HEADLESS_WARMUP_FRAMES = 30;   // Not timed: pipeline variants and arenas settle first
+const float HEADLESS_STEP = 1.0f / 60.0f;     // Simulation time per headless frame
+
+const Vec4 TEAM_COLORS[2] = {
+    {1.0f, 0.0f, 0.0f, 1.0f},  // Red
+    {0.0f, 0.0f, 1.0f, 1.0f}   // Blue
+};
 
-// Math structures
-struct Vec2 { float x, y; };
-struct Vec3 { float x, y, z; };
-struct Vec4 { float x, y, z, w; };
-struct Mat4 { float m[16]; };
-
-// Game constants
-const int PLAYERS_PER_TEAM = 11;
-const float FIELD_WIDTH = 20.0f;
-const float FIELD_HEIGHT = 30.0f;
-const float BALL_RADIUS = 0.3f;
-const float PLAYER_SIZE = 0.5f;
-const float GOAL_WIDTH = 5.0f;
-const float GOAL_DEPTH = 2.0f;
-
-// Physics constants
-const float GRAVITY = -9.8f;
-const float FRICTION = 0.98f;
-const float BOUNCE_DAMPING = 0.7f;
-const float PLAYER_SPEED = 8.0f;
+// Depth formats in order of preference. The depth buffer is transient, so on
+// tilers it never leaves tile memory and the wider formats cost no bandwidth.
+const VkFormat DEPTH_FORMAT_CANDIDATES[] = {
+    VK_FORMAT_D32_SFLOAT,
+    VK_FORMAT_D24_UNORM_S8_UINT,
+    VK_FORMAT_D16_UNORM
+};
 
 // Vertex structure
 struct Vertex {
@@ -44,6 +80,36 @@ struct Vertex {
     Vec4 color;
 };
 
+// Static meshes, generated at compile time. The cube and sphere are unit
+// sized and scaled by their model matrix.
+constexpr Vec4 PLAYER_MESH_COLOR = {1.0f, 0.0f, 0.0f, 1.0f};
+constexpr Vec4 BALL_MESH_COLOR = {1.0f, 1.0f, 1.0f, 1.0f};
+constexpr Vec4 GRASS_COLOR = {0.0f, 0.6f, 0.0f, 1.0f};
+constexpr Vec4 LINE_COLOR = {1.0f, 1.0f, 1.0f, 1.0f};
+
+// Ball LODs, finest first, and the projected diameter in pixels down to which
+// each one is used
+constexpr auto BALL_LODS = makeSphereLodChain<uint32_t, 36, 24, 16, 8>();
+constexpr int BALL_LOD_COUNT = static_cast<int>(BALL_LODS.levels.size());
+constexpr float BALL_LOD_MIN_PIXELS[BALL_LOD_COUNT] = {96.0f, 48.0f, 20.0f, 0.0f};
+
+constexpr auto CUBE_VERTICES = buildVertices<Vertex>(makeCubePositions(), [](size_t, MeshPosition p) {
+    return Vertex{{p.x, p.y, p.z}, PLAYER_MESH_COLOR};
+});
+constexpr auto CUBE_INDICES = makeCubeIndices<uint32_t>();
+constexpr float CUBE_BOUNDING_RADIUS = 0.8660254f;   // Half the unit cube's diagonal
+
+constexpr auto SPHERE_VERTICES = buildVertices<Vertex>(BALL_LODS.positions, [](size_t, MeshPosition p) {
+    return Vertex{{p.x, p.y, p.z}, BALL_MESH_COLOR};
+});
+constexpr auto& SPHERE_INDICES = BALL_LODS.indices;
+
+constexpr auto FIELD_VERTICES = buildVertices<Vertex>(
+    makeFieldPositions(FIELD_WIDTH / 2, FIELD_HEIGHT / 2, 3.0f), [](size_t i, MeshPosition p) {
+        return Vertex{{p.x, p.y, p.z}, i < FIELD_GRASS_VERTEX_COUNT ? GRASS_COLOR : LINE_COLOR};
+    });
+constexpr auto FIELD_INDICES = makeFieldIndices<uint32_t>();
+
 // Uniform buffer object
 struct UniformBufferObject {
     Mat4 model;
@@ -51,21 +117,18 @@ struct UniformBufferObject {
     Mat4 proj;
 };
 
-// Game objects
-struct Player {
-    Vec3 position;
-    Vec3 velocity;
-    Vec4 color;
-    int team; // 0 = red, 1 = blue
-    float size;
-    bool selected;
+enum SceneDebugView : uint32_t {
+    SCENE_DEBUG_VIEW_NONE,
+    SCENE_DEBUG_VIEW_LOD,
 };
 
-struct Ball {
-    Vec3 position;
-    Vec3 velocity;
-    float radius;
-    bool onGround;
+// Specialization constants of shaders/scene.frag, in constant_id order
+struct SceneSpecialization {
+    float teamR = -1.0f;   // Negative: use the vertex colour
+    float teamG = 0.0f;
+    float teamB = 0.0f;
+    uint32_t lod = 0;      // Only set for SCENE_DEBUG_VIEW_LOD, so other views share one variant
+    uint32_t debugView = SCENE_DEBUG_VIEW_NONE;
 };
 
 // Global state
@@ -84,9 +147,23 @@ private:
     VkFormat swapChainImageFormat;
     VkExtent2D swapChainExtent;
     std::vector<VkImageView> swapChainImageViews;
+    VkFormat depthFormat;
+    VkImage depthImage;
+    VkDeviceMemory depthImageMemory;
+    VkImageView depthImageView;
     VkRenderPass renderPass;
+    FrameGraph frameGraph;
+    uint32_t backbufferAttachment;
+    uint32_t depthAttachment;
+    uint32_t scenePass;
+    VkDescriptorSetLayout descriptorSetLayout;
     VkPipelineLayout pipelineLayout;
-    VkPipeline graphicsPipeline;
+    VkShaderModule sceneVertModule;
+    VkShaderModule sceneFragModule;
+    PipelineVariantCache<SceneSpecialization> scenePipelines;
+    SceneDebugView debugView = SCENE_DEBUG_VIEW_NONE;
+    VkPipelineLayout instancedPipelineLayout;
+    VkPipeline instancedPipeline;
     std::vector<VkFramebuffer> swapChainFramebuffers;
     VkCommandPool commandPool;
     std::vector<VkCommandBuffer> commandBuffers;
@@ -98,6 +175,12 @@ private:
     // Game objects
     std::vector<Player> players;
     Ball ball;
+    std::vector<Formation> formations;
+    TeamShape teamShapes[2];
+    PredictionCache prediction;
+    PlayerAI ai;
+    JobSystem jobs;   // Kickoff planning and render thread culling; sized from the job cores
+    MonteCarloPlanner planner{jobs};
     
     // Buffers
     struct {
@@ -134,11 +217,103 @@ private:
     Vec3 cameraPos = {0.0f, 15.0f, 25.0f};
     Vec3 cameraFront = {0.0f, -0.5f, -1.0f};
     Vec3 cameraUp = {0.0f, 1.0f, 0.0f};
+    Mat4 cameraViewProj = {};  // proj * view of the frame being recorded
+    Mat4 cameraInverseViewProj = {};   // Of the last frame recorded, for picking
+    bool cameraInverseValid = false;
+    int ballLod = BALL_LOD_COUNT - 1;
+    
+    // Transient data of the frames in flight, reset once their fence signals
+    FrameArenaRing frameArenas{MAX_FRAMES_IN_FLIGHT, FRAME_ARENA_CAPACITY};
+    uint64_t frameNumber = 0;
+    uint64_t allocatingFrames = 0;   // Recorded after ALLOCATION_WARMUP_FRAMES with heap allocations
+    FrustumCuller playerCuller;
+    GpuCuller gpuCuller;
+    bool gpuCulling = false;   // Cull and draw players through the compute/indirect path
+    Frustum frameFrustum = {};        // Camera frustum of the frame being recorded
+    uint32_t cullInstanceCount = 0;   // Instances uploaded for the GPU cull this frame
     
-    // Input
-    Vec2 touchPos = {0.0f, 0.0f};
+    // Simulation thread. It owns the game objects above and publishes a
+    // snapshot after every step; frames render the newest one.
+    std::thread simThread;
+    std::atomic<bool> simRunning{false};
+    struct SimulationFrame {
+        MatchSnapshot match;
+        uint64_t step;   // Simulation step it was taken after
+    };
+    TripleBuffer<SimulationFrame> matchSnapshots;
+    uint64_t simStep = 0;   // Simulation thread
+    const MatchSnapshot* frameState = nullptr;   // Snapshot of the frame being recorded
+    
+    // Input. The window callbacks (main thread) queue timestamped events;
+    // the simulation thread drains them at the start of each step and owns
+    // the touch state below.
+    enum InputEventType : uint8_t {
+        INPUT_PRESS,
+        INPUT_RELEASE,
+        INPUT_MOVE
+    };
+    struct InputEvent {
+        InputEventType type;
+        bool onGround;   // The cursor pointed at the ground plane, at ground
+        Vec3 ground;
+        std::chrono::steady_clock::time_point time;
+    };
+    SpscQueue<InputEvent, INPUT_QUEUE_CAPACITY> inputEvents;
+    Vec2 cursorPos = {0.0f, 0.0f};   // Main thread only
+    Vec3 touchTarget = {0.0f, 0.0f, 0.0f};
     bool touchActive = false;
     Player* selectedPlayer = nullptr;
+    SpatialGrid playerGrid;   // Player positions as of the last step, for picking
+    
+    // Input-to-photon latency. The simulation reports the oldest input each
+    // step applied; the render thread attaches it to the first frame taken
+    // after that step and learns when the frame reached the display from
+    // VK_GOOGLE_display_timing or VK_KHR_present_wait, or else stops the
+    // clock at submit. Present wait blocks, so it runs on its own thread:
+    // the render thread hands it present ids and drains the times it stamped
+    // as each wait returned.
+    enum PresentTiming {
+        PRESENT_TIMING_SUBMIT,
+        PRESENT_TIMING_DISPLAY_TIMING,
+        PRESENT_TIMING_PRESENT_WAIT
+    };
+    struct AppliedInput {
+        uint64_t step;
+        std::chrono::steady_clock::time_point input;
+        std::chrono::steady_clock::time_point simulated;
+    };
+    bool latencyTracking = false;
+    bool physicalDeviceProperties2 = false;   // VK_KHR_get_physical_device_properties2 is enabled
+    PresentTiming presentTiming = PRESENT_TIMING_SUBMIT;
+    PFN_vkGetPastPresentationTimingGOOGLE getPastPresentationTiming = nullptr;
+    PFN_vkWaitForPresentKHR waitForPresent = nullptr;
+    uint64_t nextPresentId = 1;
+    SpscQueue<AppliedInput, APPLIED_INPUT_QUEUE_CAPACITY> appliedInputs;
+    LatencyTracker latency;
+    struct PresentedFrame {
+        uint64_t presentId;
+        std::chrono::steady_clock::time_point time;
+    };
+    std::thread presentWaitThread;
+    bool presentWaitRunning = false;   // Guarded by presentWaitMutex
+    std::mutex presentWaitMutex;
+    std::condition_variable presentWaitWake;
+    SpscQueue<uint64_t, PRESENT_WAIT_QUEUE_CAPACITY> presentWaits;                 // Render -> present-wait thread
+    SpscQueue<PresentedFrame, PRESENT_WAIT_QUEUE_CAPACITY> presentedFrames;       // Present-wait thread -> render
+    
+    // Headless benchmark: no window or swapchain. Frames render into
+    // offscreen images in place of the swapchain's and the match steps once
+    // per frame at a fixed rate, so runs are comparable on any driver.
+    bool headless = false;
+    uint64_t headlessFrames = 0;
+    std::vector<VkDeviceMemory> offscreenImageMemory;
+    VkQueryPool timestampPool = VK_NULL_HANDLE;   // Start and end of each frame slot's commands
+    float timestampPeriod = 0.0f;                 // Nanoseconds per tick
+    uint64_t timestampMask = 0;                   // Valid bits of the graphics queue's timestamps
+    bool timestampsWritten[MAX_FRAMES_IN_FLIGHT] = {};
+    FrameTimeSeries recordTimes;
+    FrameTimeSeries submitTimes;
+    FrameTimeSeries gpuTimes;
     
     // Time tracking
     std::chrono::high_resolution_clock::time_point lastTime;
@@ -146,97 +321,29 @@ private:
 
 public:
     void run() {
-        initWindow();
+        if (const char* frames = std::getenv(HEADLESS_ENV)) {
+            headlessFrames = std::strtoull(frames, nullptr, 10);
+            headless = headlessFrames > 0;
+        }
+        if (!headless) {
+            initWindow();
+        }
         initVulkan();
         initGame();
-        mainLoop();
+        if (headless) {
+            headlessLoop();
+        } else {
+            mainLoop();
+        }
         cleanup();
-    }
-
-private:
-    // Math functions
-    Vec3 normalize(const Vec3& v) {
-        float length = sqrt(v.x*v.x + v.y*v.y + v.z*v.z);
-        return {v.x/length, v.y/length, v.z/length};
-    }
-    
-    float dot(const Vec3& a, const Vec3& b) {
-        return a.x*b.x + a.y*b.y + a.z*b.z;
-    }
-    
-    Vec3 cross(const Vec3& a, const Vec3& b) {
-        return {
-            a.y*b.z - a.z*b.y,
-            a.z*b.x - a.x*b.z,
-            a.x*b.y - a.y*b.x
-        };
-    }
-    
-    Mat4 perspective(float fov, float aspect, float near, float far) {
-        Mat4 mat = {};
-        float f = 1.0f / tan(fov * 0.5f);
-        mat.m[0] = f / aspect;
-        mat.m[5] = f;
-        mat.m[10] = far / (near - far);
-        mat.m[11] = -1.0f;
-        mat.m[14] = (far * near) / (near - far);
-        return mat;
-    }
-    
-    Mat4 lookAt(Vec3 eye, Vec3 center, Vec3 up) {
-        Mat4 mat = {};
-        Vec3 f = normalize({center.x - eye.x, center.y - eye.y, center.z - eye.z});
-        Vec3 s = normalize(cross(f, up));
-        Vec3 u = cross(s, f);
-        
-        mat.m[0] = s.x;
-        mat.m[1] = u.x;
-        mat.m[2] = -f.x;
-        mat.m[4] = s.y;
-        mat.m[5] = u.y;
-        mat.m[6] = -f.y;
-        mat.m[8] = s.z;
-        mat.m[9] = u.z;
-        mat.m[10] = -f.z;
-        mat.m[12] = -dot(s, eye);
-        mat.m[13] = -dot(u, eye);
-        mat.m[14] = dot(f, eye);
-        mat.m[15] = 1.0f;
-        
-        return mat;
-    }
-    
-    Mat4 translate(float x, float y, float z) {
-        Mat4 mat = {
-            1.0f, 0.0f, 0.0f, 0.0f,
-            0.0f, 1.0f, 0.0f, 0.0f,
-            0.0f, 0.0f, 1.0f, 0.0f,
-            x, y, z, 1.0f
-        };
-        return mat;
-    }
-    
-    Mat4 scale(float x, float y, float z) {
-        Mat4 mat = {};
-        mat.m[0] = x;
-        mat.m[5] = y;
-        mat.m[10] = z;
-        mat.m[15] = 1.0f;
-        return mat;
-    }
-    
-    Mat4 multiply(const Mat4& a, const Mat4& b) {
-        Mat4 mat = {};
-        for (int i = 0; i < 4; i++) {
-            for (int j = 0; j < 4; j++) {
-                for (int k = 0; k < 4; k++) {
-                    mat.m[i*4 + j] += a.m[i*4 + k] * b.m[k*4 + j];
-                }
-            }
+        
+        // A headless run is a benchmark: allocating frames fail it
+        if (headless && allocatingFrames > 0) {
+            throw std::runtime_error(std::to_string(allocatingFrames) + " frames allocated on the heap after warm-up!");
         }
-        return mat;
     }
 
+private:
     void initWindow() {
         glfwInit();
         glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
@@ -245,7 +352,7 @@ private:
         
         // Setup touch/mouse callbacks
         glfwSetWindowUserPointer(window, this);
-        glfwSetMouseButtonCallback(window, [](GLFWwindow* window, int button, int action, int mods) {
+        glfwSetMouseButtonCallback(window, [](GLFWwindow* window, int button, int action, [[maybe_unused]] int mods) {
             auto* app = reinterpret_cast<VulkanSoccerEngine*>(glfwGetWindowUserPointer(window));
             app->onTouch(button, action);
         });
@@ -257,56 +364,61 @@ private:
 
     void onTouch(int button, int action) {
         if (button == GLFW_MOUSE_BUTTON_LEFT) {
-            touchActive = (action == GLFW_PRESS);
-            if (touchActive) {
-                // Select nearest player to touch
-                float minDist = std::numeric_limits<float>::max();
-                selectedPlayer = nullptr;
-                
-                // Convert screen to world coordinates (simplified)
-                float worldX = (touchPos.x / WINDOW_WIDTH - 0.5f) * 40.0f;
-                float worldZ = (touchPos.y / WINDOW_HEIGHT - 0.5f) * 40.0f;
-                
-                for (auto& player : players) {
-                    float dist = sqrt(pow(player.position.x - worldX, 2) + 
-                                    pow(player.position.z - worldZ, 2));
-                    if (dist < minDist && dist < 5.0f) {
-                        minDist = dist;
-                        selectedPlayer = &player;
-                    }
-                }
-                
-                if (selectedPlayer) {
-                    selectedPlayer->selected = true;
-                    // Deselect others
-                    for (auto& player : players) {
-                        if (&player != selectedPlayer) {
-                            player.selected = false;
-                        }
-                    }
-                }
-            } else {
-                if (selectedPlayer) {
-                    selectedPlayer->selected = false;
-                    selectedPlayer = nullptr;
-                }
-            }
+            queueInputEvent(action == GLFW_PRESS ? INPUT_PRESS : INPUT_RELEASE);
         }
     }
 
     void onTouchMove(double xpos, double ypos) {
-        touchPos.x = static_cast<float>(xpos);
-        touchPos.y = static_cast<float>(ypos);
+        cursorPos = {static_cast<float>(xpos), static_cast<float>(ypos)};
+        queueInputEvent(INPUT_MOVE);
+    }
+
+    // Callbacks run on the render thread between frames, so the cursor is
+    // unprojected through exactly the camera the user is looking at
+    void queueInputEvent(InputEventType type) {
+        InputEvent event = {type, false, {0.0f, 0.0f, 0.0f}, std::chrono::steady_clock::now()};
+        if (cameraInverseValid) {
+            Ray ray = screenRay(cameraInverseViewProj, cursorPos.x, cursorPos.y, WINDOW_WIDTH, WINDOW_HEIGHT);
+            event.onGround = intersectGround(ray, 0.0f, event.ground);
+        }
+        // A full queue means the simulation is stalled; dropping the event
+        // beats blocking the event loop
+        inputEvents.push(event);
+    }
+
+    // Simulation thread: applies the events queued before this step began,
+    // however many there were. A press selects the nearest player, and
+    // while the touch is held the selected player moves toward it once per
+    // step.
+    void applyInputEvents() {
+        auto stepStart = std::chrono::steady_clock::now();
+        bool applied = false;
+        while (const InputEvent* next = inputEvents.peek()) {
+            if (next->time > stepStart) {
+                break;   // Arrived during this step; the next one takes it
+            }
+            InputEvent event;
+            if (!inputEvents.pop(event)) {
+                break;
+            }
+            if (latencyTracking && !applied) {
+                applied = true;
+                appliedInputs.push({simStep, event.time, stepStart});
+            }
+            if (event.onGround) {
+                touchTarget = event.ground;
+            }
+            if (event.type != INPUT_MOVE) {
+                setTouchActive(event.type == INPUT_PRESS, event.onGround);
+            }
+        }
         
         if (touchActive && selectedPlayer) {
             // Move selected player toward touch position
-            float worldX = (touchPos.x / WINDOW_WIDTH - 0.5f) * 40.0f;
-            float worldZ = (touchPos.y / WINDOW_HEIGHT - 0.5f) * 40.0f;
-            
             Vec3 direction = {
-                worldX - selectedPlayer->position.x,
+                touchTarget.x - selectedPlayer->position.x,
                 0.0f,
-                worldZ - selectedPlayer->position.z
+                touchTarget.z - selectedPlayer->position.z
             };
             
             // Normalize and apply speed
@@ -329,16 +441,62 @@ private:
         }
     }
 
+    // A press that misses the ground selects nothing
+    void setTouchActive(bool active, bool onGround) {
+        if (active != touchActive) {
+            touchActive = active;
+            if (touchActive) {
+                // Select nearest player to touch
+                int32_t nearest = onGround ? playerGrid.nearest(touchTarget.x, touchTarget.z, PLAYER_PICK_RADIUS) : -1;
+                selectedPlayer = nearest >= 0 ? &players[nearest] : nullptr;
+                
+                if (selectedPlayer) {
+                    selectedPlayer->selected = true;
+                    // Deselect others
+                    for (auto& player : players) {
+                        if (&player != selectedPlayer) {
+                            player.selected = false;
+                        }
+                    }
+                }
+            } else {
+                if (selectedPlayer) {
+                    selectedPlayer->selected = false;
+                    selectedPlayer = nullptr;
+                }
+            }
+        }
+    }
+
     void initVulkan() {
+        latencyTracking = !headless && std::getenv(LATENCY_ENV) != nullptr;
         createInstance();
-        createSurface();
+        if (!headless) {
+            createSurface();
+        }
         pickPhysicalDevice();
         createLogicalDevice();
-        createSwapChain();
+        if (headless) {
+            createOffscreenImages();
+            createTimestampPool();
+        } else {
+            createSwapChain();
+        }
         createImageViews();
-        createRenderPass();
+        depthFormat = findDepthFormat();
+        gpuCulling = std::getenv(GPU_CULLING_ENV) != nullptr;
+        const char* debugViewName = std::getenv(DEBUG_VIEW_ENV);
+        if (debugViewName && strcmp(debugViewName, "lod") == 0) {
+            debugView = SCENE_DEBUG_VIEW_LOD;
+        }
+        createFrameGraph();
         createDescriptorSetLayout();
         createGraphicsPipeline();
+        if (gpuCulling) {
+            gpuCuller.create(device, physicalDevice, GPU_CULL_MAX_INSTANCES, MAX_FRAMES_IN_FLIGHT);
+            createInstancedPipeline();
+        }
+        createDepthResources();
         createFramebuffers();
         createCommandPool();
         createVertexBuffers();
@@ -363,11 +521,20 @@ private:
         createInfo.pApplicationInfo = &appInfo;
 
         uint32_t glfwExtensionCount = 0;
-        const char** glfwExtensions;
-        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        const char** glfwExtensions = nullptr;
+        if (!headless) {
+            glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        }
+
+        // Present wait needs its device features queried first
+        std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        if (latencyTracking && instanceExtensionSupported(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME)) {
+            extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+            physicalDeviceProperties2 = true;
+        }
 
-        createInfo.enabledExtensionCount = glfwExtensionCount;
-        createInfo.ppEnabledExtensionNames = glfwExtensions;
+        createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+        createInfo.ppEnabledExtensionNames = extensions.data();
         createInfo.enabledLayerCount = 0;
 
         if (vkCreateInstance(&createInfo, nullptr, &instance) != VK_SUCCESS) {
@@ -375,6 +542,32 @@ private:
         }
     }
 
+    bool instanceExtensionSupported(const char* name) {
+        uint32_t count = 0;
+        vkEnumerateInstanceExtensionProperties(nullptr, &count, nullptr);
+        std::vector<VkExtensionProperties> extensions(count);
+        vkEnumerateInstanceExtensionProperties(nullptr, &count, extensions.data());
+        for (const auto& extension : extensions) {
+            if (strcmp(extension.extensionName, name) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool deviceExtensionSupported(const char* name) {
+        uint32_t count = 0;
+        vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, nullptr);
+        std::vector<VkExtensionProperties> extensions(count);
+        vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, extensions.data());
+        for (const auto& extension : extensions) {
+            if (strcmp(extension.extensionName, name) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     void createSurface() {
         if (glfwCreateWindowSurface(instance, window, nullptr, &surface) != VK_SUCCESS) {
             throw std::runtime_error("failed to create window surface!");
@@ -407,7 +600,28 @@ private:
         createInfo.queueCreateInfoCount = 1;
         createInfo.pQueueCreateInfos = &queueCreateInfo;
         createInfo.pEnabledFeatures = &deviceFeatures;
-        createInfo.enabledExtensionCount = 0;
+        
+        std::vector<const char*> extensions;
+        if (!headless) {
+            extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        }
+        VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{};
+        presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+        VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{};
+        presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+        presentWaitFeatures.pNext = &presentIdFeatures;
+        if (latencyTracking) {
+            presentTiming = choosePresentTiming(presentWaitFeatures);
+            if (presentTiming == PRESENT_TIMING_DISPLAY_TIMING) {
+                extensions.push_back(VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME);
+            } else if (presentTiming == PRESENT_TIMING_PRESENT_WAIT) {
+                extensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+                extensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+                createInfo.pNext = &presentWaitFeatures;
+            }
+        }
+        createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+        createInfo.ppEnabledExtensionNames = extensions.data();
         
         if (vkCreateDevice(physicalDevice, &createInfo, nullptr, &device) != VK_SUCCESS) {
             throw std::runtime_error("failed to create logical device!");
@@ -415,6 +629,41 @@ private:
         
         vkGetDeviceQueue(device, 0, 0, &graphicsQueue);
         vkGetDeviceQueue(device, 0, 0, &presentQueue);
+        
+        if (presentTiming == PRESENT_TIMING_DISPLAY_TIMING) {
+            getPastPresentationTiming = reinterpret_cast<PFN_vkGetPastPresentationTimingGOOGLE>(
+                vkGetDeviceProcAddr(device, "vkGetPastPresentationTimingGOOGLE"));
+        } else if (presentTiming == PRESENT_TIMING_PRESENT_WAIT) {
+            waitForPresent = reinterpret_cast<PFN_vkWaitForPresentKHR>(vkGetDeviceProcAddr(device, "vkWaitForPresentKHR"));
+        }
+        if (latencyTracking && !getPastPresentationTiming && !waitForPresent) {
+            presentTiming = PRESENT_TIMING_SUBMIT;
+        }
+    }
+
+    // Display timing reports when each image actually hit the display, the
+    // best there is. Present wait only unblocks once it has, so the time is
+    // stamped as the wait returns, a thread wake-up late. Fills features (a
+    // chain of present wait then present id) with what the device supports.
+    PresentTiming choosePresentTiming(VkPhysicalDevicePresentWaitFeaturesKHR& features) {
+        if (deviceExtensionSupported(VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME)) {
+            return PRESENT_TIMING_DISPLAY_TIMING;
+        }
+        if (!physicalDeviceProperties2 || !deviceExtensionSupported(VK_KHR_PRESENT_ID_EXTENSION_NAME) ||
+            !deviceExtensionSupported(VK_KHR_PRESENT_WAIT_EXTENSION_NAME)) {
+            return PRESENT_TIMING_SUBMIT;
+        }
+        auto getFeatures2 = reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(
+            vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceFeatures2KHR"));
+        if (!getFeatures2) {
+            return PRESENT_TIMING_SUBMIT;
+        }
+        VkPhysicalDeviceFeatures2 supported{};
+        supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        supported.pNext = &features;
+        getFeatures2(physicalDevice, &supported);
+        auto* presentId = static_cast<VkPhysicalDevicePresentIdFeaturesKHR*>(features.pNext);
+        return features.presentWait && presentId->presentId ? PRESENT_TIMING_PRESENT_WAIT : PRESENT_TIMING_SUBMIT;
     }
 
     void createSwapChain() {
@@ -454,6 +703,75 @@ private:
         swapChainImageFormat = VK_FORMAT_B8G8R8A8_SRGB;
     }
 
+    // Headless stand-in for the swapchain: one image per frame in flight, in
+    // the swapchain's format and the window's size, so everything downstream
+    // renders exactly as it would to the screen
+    void createOffscreenImages() {
+        swapChainImageFormat = VK_FORMAT_B8G8R8A8_SRGB;
+        swapChainExtent = {WINDOW_WIDTH, WINDOW_HEIGHT};
+        swapChainImages.resize(MAX_FRAMES_IN_FLIGHT);
+        offscreenImageMemory.resize(MAX_FRAMES_IN_FLIGHT);
+        
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            VkImageCreateInfo imageInfo{};
+            imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.format = swapChainImageFormat;
+            imageInfo.extent = {swapChainExtent.width, swapChainExtent.height, 1};
+            imageInfo.mipLevels = 1;
+            imageInfo.arrayLayers = 1;
+            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            
+            if (vkCreateImage(device, &imageInfo, nullptr, &swapChainImages[i]) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create offscreen image!");
+            }
+            
+            VkMemoryRequirements memRequirements;
+            vkGetImageMemoryRequirements(device, swapChainImages[i], &memRequirements);
+            
+            VkMemoryAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            allocInfo.allocationSize = memRequirements.size;
+            allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            
+            if (vkAllocateMemory(device, &allocInfo, nullptr, &offscreenImageMemory[i]) != VK_SUCCESS) {
+                throw std::runtime_error("failed to allocate offscreen image memory!");
+            }
+            vkBindImageMemory(device, swapChainImages[i], offscreenImageMemory[i], 0);
+        }
+    }
+
+    // GPU time of each frame from timestamps around its commands; left out
+    // when the graphics queue has none
+    void createTimestampPool() {
+        uint32_t familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> families(familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        if (familyCount == 0 || families[0].timestampValidBits == 0 || properties.limits.timestampPeriod == 0.0f) {
+            std::cout << "no timestamp queries on the graphics queue, GPU time not measured" << std::endl;
+            return;
+        }
+        uint32_t validBits = families[0].timestampValidBits;
+        timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+        timestampPeriod = properties.limits.timestampPeriod;
+        
+        VkQueryPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        poolInfo.queryCount = 2 * MAX_FRAMES_IN_FLIGHT;
+        
+        if (vkCreateQueryPool(device, &poolInfo, nullptr, &timestampPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create timestamp query pool!");
+        }
+    }
+
     void createImageViews() {
         swapChainImageViews.resize(swapChainImages.size());
         
@@ -479,46 +797,56 @@ private:
         }
     }
 
-    void createRenderPass() {
-        VkAttachmentDescription colorAttachment{};
-        colorAttachment.format = swapChainImageFormat;
-        colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-        colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-        colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-        colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-        colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-        
-        VkAttachmentReference colorAttachmentRef{};
-        colorAttachmentRef.attachment = 0;
-        colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-        
-        VkSubpassDescription subpass{};
-        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-        subpass.colorAttachmentCount = 1;
-        subpass.pColorAttachments = &colorAttachmentRef;
-        
-        VkSubpassDependency dependency{};
-        dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-        dependency.dstSubpass = 0;
-        dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        dependency.srcAccessMask = 0;
-        dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-        
-        VkRenderPassCreateInfo renderPassInfo{};
-        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-        renderPassInfo.attachmentCount = 1;
-        renderPassInfo.pAttachments = &colorAttachment;
-        renderPassInfo.subpassCount = 1;
-        renderPassInfo.pSubpasses = &subpass;
-        renderPassInfo.dependencyCount = 1;
-        renderPassInfo.pDependencies = &dependency;
-        
-        if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create render pass!");
+    // The frame as a graph of passes declaring what they read and write; the
+    // render pass, its load/store ops, the barriers between passes and the
+    // lifetime of transient images all follow from it. New passes (shadows,
+    // post-processing, HUD) are added here without hand-written sync.
+    void createFrameGraph() {
+        frameGraph = FrameGraph();
+        // Offscreen images are left ready to be copied out instead of shown
+        VkImageLayout backbufferLayout = headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        FrameGraphAttachment backbuffer = {swapChainImageFormat, false, true, true, backbufferLayout};
+        backbuffer.clearValue.color = {{0.1f, 0.1f, 0.1f, 1.0f}};
+        FrameGraphAttachment depth = {depthFormat, true, true, false, VK_IMAGE_LAYOUT_UNDEFINED};
+        depth.clearValue.depthStencil = {1.0f, 0};
+        backbufferAttachment = frameGraph.addAttachment(backbuffer);
+        depthAttachment = frameGraph.addAttachment(depth);
+        
+        FrameGraphPass scene;
+        scene.name = "scene";
+        scene.colorOutputs = {backbufferAttachment};
+        scene.depthOutput = static_cast<int32_t>(depthAttachment);
+        scene.record = [this](VkCommandBuffer commandBuffer) { recordScene(commandBuffer); };
+        
+        if (gpuCulling) {
+            uint32_t cullCommand = frameGraph.addBuffer(false);
+            uint32_t cullVisible = frameGraph.addBuffer(false);
+            
+            FrameGraphPass reset;
+            reset.name = "cull reset";
+            reset.buffers = {{cullCommand, FRAME_GRAPH_TRANSFER_WRITE}};
+            reset.record = [this](VkCommandBuffer commandBuffer) {
+                MeshRange cube = {0, static_cast<uint32_t>(CUBE_INDICES.size()), 0};
+                gpuCuller.recordReset(commandBuffer, static_cast<uint32_t>(currentFrame), cube);
+            };
+            frameGraph.addPass(std::move(reset));
+            
+            FrameGraphPass cull;
+            cull.name = "cull";
+            cull.buffers = {{cullCommand, FRAME_GRAPH_COMPUTE_WRITE}, {cullVisible, FRAME_GRAPH_COMPUTE_WRITE}};
+            cull.record = [this](VkCommandBuffer commandBuffer) {
+                gpuCuller.recordDispatch(commandBuffer, static_cast<uint32_t>(currentFrame), cullInstanceCount,
+                                         frameFrustum);
+            };
+            frameGraph.addPass(std::move(cull));
+            
+            scene.buffers = {{cullCommand, FRAME_GRAPH_INDIRECT_READ}, {cullVisible, FRAME_GRAPH_VERTEX_SHADER_READ}};
         }
+        scenePass = frameGraph.addPass(std::move(scene));
+        
+        frameGraph.compile();
+        frameGraph.createRenderPasses(device);
+        renderPass = frameGraph.renderPass(scenePass);
     }
 
     void createDescriptorSetLayout() {
@@ -533,36 +861,123 @@ private:
         layoutInfo.bindingCount = 1;
         layoutInfo.pBindings = &uboLayoutBinding;
         
-        if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+        if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
             throw std::runtime_error("failed to create descriptor set layout!");
         }
     }
 
     void createGraphicsPipeline() {
-        // Hardcoded shaders
-        const uint32_t vertShaderCode[] = {
+        // SPIR-V compiled and optimised at build time (shaders/shaders.cmake)
+        static constexpr uint32_t vertShaderCode[] = {
             #include "vert.spv"
         };
         
-        const uint32_t fragShaderCode[] = {
+        static constexpr uint32_t fragShaderCode[] = {
+            #include "frag.spv"
+        };
+        
+        // Pipeline layout: the camera in the uniform buffer, the model
+        // matrix in a push constant
+        VkPushConstantRange pushRange{};
+        pushRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        pushRange.offset = 0;
+        pushRange.size = sizeof(Mat4);
+        
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushRange;
+        
+        if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create pipeline layout!");
+        }
+        
+        // The scene shaders stay loaded: every new specialization variant
+        // is another pipeline from the same modules
+        sceneVertModule = createShaderModule(vertShaderCode, sizeof(vertShaderCode));
+        sceneFragModule = createShaderModule(fragShaderCode, sizeof(fragShaderCode));
+        scenePipelines.create(device, [this](const VkSpecializationInfo& specialization) {
+            return createPipeline(sceneVertModule, sceneFragModule, pipelineLayout, &specialization);
+        });
+        
+        // Create the variants every frame uses up front rather than on the
+        // first frame that draws them
+        scenePipelines.get(sceneVariant());
+        for (int team = 0; team < 2; team++) {
+            scenePipelines.get(teamVariant(team));
+        }
+    }
+
+    SceneSpecialization sceneVariant(uint32_t lod = 0) const {
+        SceneSpecialization variant;
+        variant.debugView = debugView;
+        if (debugView == SCENE_DEBUG_VIEW_LOD) {
+            variant.lod = lod;
+        }
+        return variant;
+    }
+
+    SceneSpecialization teamVariant(int team) const {
+        SceneSpecialization variant = sceneVariant();
+        variant.teamR = TEAM_COLORS[team].x;
+        variant.teamG = TEAM_COLORS[team].y;
+        variant.teamB = TEAM_COLORS[team].z;
+        return variant;
+    }
+
+    // Players drawn from the GPU culling results: instance data comes from
+    // the culler's storage buffers, the camera from a push constant
+    void createInstancedPipeline() {
+        static constexpr uint32_t vertShaderCode[] = {
+            #include "instanced.vert.spv"
+        };
+        
+        static constexpr uint32_t fragShaderCode[] = {
             #include "frag.spv"
         };
         
-        // Create shader modules
+        VkPushConstantRange pushRange{};
+        pushRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        pushRange.offset = 0;
+        pushRange.size = sizeof(Mat4);
+        
+        VkDescriptorSetLayout setLayout = gpuCuller.drawSetLayout();
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &setLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushRange;
+        
+        if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &instancedPipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create instanced pipeline layout!");
+        }
+        
         VkShaderModule vertShaderModule = createShaderModule(vertShaderCode, sizeof(vertShaderCode));
         VkShaderModule fragShaderModule = createShaderModule(fragShaderCode, sizeof(fragShaderCode));
-        
+        instancedPipeline = createPipeline(vertShaderModule, fragShaderModule, instancedPipelineLayout);
+        vkDestroyShaderModule(device, fragShaderModule, nullptr);
+        vkDestroyShaderModule(device, vertShaderModule, nullptr);
+    }
+
+    // The specialization, if any, applies to both stages
+    VkPipeline createPipeline(VkShaderModule vertShaderModule, VkShaderModule fragShaderModule, VkPipelineLayout layout,
+                              const VkSpecializationInfo* specialization = nullptr) {
         VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
         vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
         vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
         vertShaderStageInfo.module = vertShaderModule;
         vertShaderStageInfo.pName = "main";
+        vertShaderStageInfo.pSpecializationInfo = specialization;
         
         VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
         fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
         fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
         fragShaderStageInfo.module = fragShaderModule;
         fragShaderStageInfo.pName = "main";
+        fragShaderStageInfo.pSpecializationInfo = specialization;
         
         VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
         
@@ -633,6 +1048,15 @@ private:
         multisampling.sampleShadingEnable = VK_FALSE;
         multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
         
+        // Depth test
+        VkPipelineDepthStencilStateCreateInfo depthStencil{};
+        depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        depthStencil.depthTestEnable = VK_TRUE;
+        depthStencil.depthWriteEnable = VK_TRUE;
+        depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+        depthStencil.depthBoundsTestEnable = VK_FALSE;
+        depthStencil.stencilTestEnable = VK_FALSE;
+        
         // Color blending
         VkPipelineColorBlendAttachmentState colorBlendAttachment{};
         colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
@@ -644,16 +1068,6 @@ private:
         colorBlending.attachmentCount = 1;
         colorBlending.pAttachments = &colorBlendAttachment;
         
-        // Pipeline layout
-        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipelineLayoutInfo.setLayoutCount = 1;
-        pipelineLayoutInfo.pSetLayouts = &pipelineLayout;
-        
-        if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create pipeline layout!");
-        }
-        
         // Create graphics pipeline
         VkGraphicsPipelineCreateInfo pipelineInfo{};
         pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
@@ -664,18 +1078,18 @@ private:
         pipelineInfo.pViewportState = &viewportState;
         pipelineInfo.pRasterizationState = &rasterizer;
         pipelineInfo.pMultisampleState = &multisampling;
+        pipelineInfo.pDepthStencilState = &depthStencil;
         pipelineInfo.pColorBlendState = &colorBlending;
-        pipelineInfo.layout = pipelineLayout;
+        pipelineInfo.layout = layout;
         pipelineInfo.renderPass = renderPass;
         pipelineInfo.subpass = 0;
         
-        if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
+        VkPipeline pipeline;
+        if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
             throw std::runtime_error("failed to create graphics pipeline!");
         }
         
-        // Cleanup shader modules
-        vkDestroyShaderModule(device, fragShaderModule, nullptr);
-        vkDestroyShaderModule(device, vertShaderModule, nullptr);
+        return pipeline;
     }
 
     VkShaderModule createShaderModule(const uint32_t* code, size_t size) {
@@ -695,13 +1109,16 @@ private:
         swapChainFramebuffers.resize(swapChainImageViews.size());
         
         for (size_t i = 0; i < swapChainImageViews.size(); i++) {
-            VkImageView attachments[] = {swapChainImageViews[i]};
+            std::vector<VkImageView> attachments;
+            for (uint32_t attachment : frameGraph.framebufferAttachments(scenePass)) {
+                attachments.push_back(attachment == depthAttachment ? depthImageView : swapChainImageViews[i]);
+            }
             
             VkFramebufferCreateInfo framebufferInfo{};
             framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
             framebufferInfo.renderPass = renderPass;
-            framebufferInfo.attachmentCount = 1;
-            framebufferInfo.pAttachments = attachments;
+            framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+            framebufferInfo.pAttachments = attachments.data();
             framebufferInfo.width = swapChainExtent.width;
             framebufferInfo.height = swapChainExtent.height;
             framebufferInfo.layers = 1;
@@ -712,154 +1129,86 @@ private:
         }
     }
 
-    void createCommandPool() {
-        VkCommandPoolCreateInfo poolInfo{};
-        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-        poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-        
-        if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create command pool!");
-        }
-    }
-
-    std::vector<Vertex> createCubeVertices(float size, Vec4 color) {
-        float s = size / 2.0f;
-        std::vector<Vertex> vertices = {
-            // Front face
-            {{-s, -s, s}, color}, {{s, -s, s}, color}, {{s, s, s}, color}, {{-s, s, s}, color},
-            // Back face
-            {{-s, -s, -s}, color}, {{-s, s, -s}, color}, {{s, s, -s}, color}, {{s, -s, -s}, color},
-            // Top face
-            {{-s, s, -s}, color}, {{-s, s, s}, color}, {{s, s, s}, color}, {{s, s, -s}, color},
-            // Bottom face
-            {{-s, -s, -s}, color}, {{s, -s, -s}, color}, {{s, -s, s}, color}, {{-s, -s, s}, color},
-            // Right face
-            {{s, -s, -s}, color}, {{s, s, -s}, color}, {{s, s, s}, color}, {{s, -s, s}, color},
-            // Left face
-            {{-s, -s, -s}, color}, {{-s, -s, s}, color}, {{-s, s, s}, color}, {{-s, s, -s}, color}
-        };
-        return vertices;
-    }
-
-    std::vector<uint32_t> createCubeIndices() {
-        return {
-            0,1,2, 2,3,0,       // Front
-            4,5,6, 6,7,4,       // Back
-            8,9,10, 10,11,8,    // Top
-            12,13,14, 14,15,12, // Bottom
-            16,17,18, 18,19,16, // Right
-            20,21,22, 22,23,20  // Left
-        };
-    }
-
-    std::vector<Vertex> createSphereVertices(float radius, Vec4 color, int sectors = 36, int stacks = 18) {
-        std::vector<Vertex> vertices;
-        
-        float sectorStep = 2 * M_PI / sectors;
-        float stackStep = M_PI / stacks;
-        
-        for (int i = 0; i <= stacks; ++i) {
-            float stackAngle = M_PI / 2 - i * stackStep;
-            float xy = radius * cosf(stackAngle);
-            float z = radius * sinf(stackAngle);
-            
-            for (int j = 0; j <= sectors; ++j) {
-                float sectorAngle = j * sectorStep;
-                float x = xy * cosf(sectorAngle);
-                float y = xy * sinf(sectorAngle);
-                vertices.push_back({{x, y, z}, color});
+    VkFormat findDepthFormat() {
+        for (VkFormat format : DEPTH_FORMAT_CANDIDATES) {
+            VkFormatProperties props;
+            vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &props);
+            if (props.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT) {
+                return format;
             }
         }
-        
-        return vertices;
+        throw std::runtime_error("failed to find supported depth format!");
     }
 
-    std::vector<uint32_t> createSphereIndices(int sectors = 36, int stacks = 18) {
-        std::vector<uint32_t> indices;
-        
-        for (int i = 0; i < stacks; ++i) {
-            int k1 = i * (sectors + 1);
-            int k2 = k1 + sectors + 1;
-            
-            for (int j = 0; j < sectors; ++j, ++k1, ++k2) {
-                if (i != 0) {
-                    indices.push_back(k1);
-                    indices.push_back(k2);
-                    indices.push_back(k1 + 1);
-                }
-                if (i != (stacks - 1)) {
-                    indices.push_back(k1 + 1);
-                    indices.push_back(k2);
-                    indices.push_back(k2 + 1);
-                }
-            }
+    void createDepthResources() {
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = depthFormat;
+        imageInfo.extent = {swapChainExtent.width, swapChainExtent.height, 1};
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        if (frameGraph.isTransient(depthAttachment)) {
+            imageInfo.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
         }
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
         
-        return indices;
-    }
-
-    std::vector<Vertex> createFieldVertices() {
-        float w = FIELD_WIDTH / 2;
-        float h = FIELD_HEIGHT / 2;
-        Vec4 green = {0.0f, 0.6f, 0.0f, 1.0f};
-        Vec4 white = {1.0f, 1.0f, 1.0f, 1.0f};
-        
-        std::vector<Vertex> vertices;
-        
-        // Green field
-        vertices.push_back({{-w, 0.0f, -h}, green});
-        vertices.push_back({{w, 0.0f, -h}, green});
-        vertices.push_back({{w, 0.0f, h}, green});
-        vertices.push_back({{-w, 0.0f, h}, green});
-        
-        // White lines (border)
-        float borderWidth = 0.1f;
-        float innerW = w - borderWidth;
-        float innerH = h - borderWidth;
-        
-        // Outer border
-        for (float angle = 0; angle < 2*M_PI; angle += M_PI/20) {
-            vertices.push_back({{w*cos(angle), 0.01f, h*sin(angle)}, white});
+        if (vkCreateImage(device, &imageInfo, nullptr, &depthImage) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create depth image!");
         }
         
-        // Center line
-        vertices.push_back({{0.0f, 0.01f, -h}, white});
-        vertices.push_back({{0.0f, 0.01f, h}, white});
-        
-        // Center circle
-        float circleRadius = 3.0f;
-        for (float angle = 0; angle < 2*M_PI; angle += M_PI/20) {
-            vertices.push_back({{circleRadius*cos(angle), 0.01f, circleRadius*sin(angle)}, white});
+        VkMemoryRequirements memRequirements;
+        vkGetImageMemoryRequirements(device, depthImage, &memRequirements);
+        
+        // Tilers expose lazily allocated memory that is never backed as long
+        // as the attachment stays in tile memory; desktop GPUs fall back to
+        // ordinary device-local memory
+        // Transient images share one allocation, overlapping wherever their
+        // lifetimes in the frame graph do not
+        std::vector<VkDeviceSize> offsets;
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = frameGraph.planAliasing({depthAttachment}, {memRequirements}, offsets);
+        if (!frameGraph.isTransient(depthAttachment) || !findOptionalMemoryType(memRequirements.memoryTypeBits,
+                                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT,
+                                    allocInfo.memoryTypeIndex)) {
+            allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
         }
         
-        return vertices;
+        if (vkAllocateMemory(device, &allocInfo, nullptr, &depthImageMemory) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate depth image memory!");
+        }
+        vkBindImageMemory(device, depthImage, depthImageMemory, offsets[0]);
+        frameGraph.bindImage(depthAttachment, depthImage);
+        
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = depthImage;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = depthFormat;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+        
+        if (vkCreateImageView(device, &viewInfo, nullptr, &depthImageView) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create depth image view!");
+        }
     }
 
-    std::vector<uint32_t> createFieldIndices() {
-        std::vector<uint32_t> indices;
-        
-        // Field quad
-        indices.push_back(0); indices.push_back(1); indices.push_back(2);
-        indices.push_back(2); indices.push_back(3); indices.push_back(0);
-        
-        // Border lines (line strips)
-        for (uint32_t i = 4; i < 44; i++) {
-            indices.push_back(i);
-            indices.push_back(i+1);
-        }
-        indices.push_back(43); indices.push_back(4);
-        
-        // Center line
-        indices.push_back(44); indices.push_back(45);
+    void createCommandPool() {
+        VkCommandPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
         
-        // Center circle
-        for (uint32_t i = 46; i < 86; i++) {
-            indices.push_back(i);
-            indices.push_back(i+1);
+        if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create command pool!");
         }
-        indices.push_back(85); indices.push_back(46);
-        
-        return indices;
     }
 
     void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, 
@@ -890,17 +1239,25 @@ private:
     }
 
     uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
+        uint32_t index;
+        if (!findOptionalMemoryType(typeFilter, properties, index)) {
+            throw std::runtime_error("failed to find suitable memory type!");
+        }
+        return index;
+    }
+
+    bool findOptionalMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties, uint32_t& index) {
         VkPhysicalDeviceMemoryProperties memProperties;
         vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
         
         for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
             if ((typeFilter & (1 << i)) && 
                 (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-                return i;
+                index = i;
+                return true;
             }
         }
-        
-        throw std::runtime_error("failed to find suitable memory type!");
+        return false;
     }
 
     void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
@@ -937,12 +1294,9 @@ private:
     }
 
     void createVertexBuffers() {
-        // Create cube vertices and indices
-        auto cubeVertices = createCubeVertices(PLAYER_SIZE, {1.0f, 0.0f, 0.0f, 1.0f});
-        auto cubeIndices = createCubeIndices();
-        
-        VkDeviceSize vertexBufferSize = sizeof(cubeVertices[0]) * cubeVertices.size();
-        VkDeviceSize indexBufferSize = sizeof(cubeIndices[0]) * cubeIndices.size();
+        // Cube vertices and indices
+        VkDeviceSize vertexBufferSize = sizeof(CUBE_VERTICES);
+        VkDeviceSize indexBufferSize = sizeof(CUBE_INDICES);
         
         // Create staging buffers
         VkBuffer vertexStagingBuffer;
@@ -953,7 +1307,7 @@ private:
         
         void* data;
         vkMapMemory(device, vertexStagingBufferMemory, 0, vertexBufferSize, 0, &data);
-        memcpy(data, cubeVertices.data(), (size_t) vertexBufferSize);
+        memcpy(data, CUBE_VERTICES.data(), (size_t) vertexBufferSize);
         vkUnmapMemory(device, vertexStagingBufferMemory);
         
         createBuffer(vertexBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
@@ -972,7 +1326,7 @@ private:
                      indexStagingBuffer, indexStagingBufferMemory);
         
         vkMapMemory(device, indexStagingBufferMemory, 0, indexBufferSize, 0, &data);
-        memcpy(data, cubeIndices.data(), (size_t) indexBufferSize);
+        memcpy(data, CUBE_INDICES.data(), (size_t) indexBufferSize);
         vkUnmapMemory(device, indexStagingBufferMemory);
         
         createBuffer(indexBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
@@ -983,12 +1337,9 @@ private:
         vkDestroyBuffer(device, indexStagingBuffer, nullptr);
         vkFreeMemory(device, indexStagingBufferMemory, nullptr);
         
-        // Create sphere vertices and indices
-        auto sphereVertices = createSphereVertices(BALL_RADIUS, {1.0f, 1.0f, 1.0f, 1.0f});
-        auto sphereIndices = createSphereIndices();
-        
-        vertexBufferSize = sizeof(sphereVertices[0]) * sphereVertices.size();
-        indexBufferSize = sizeof(sphereIndices[0]) * sphereIndices.size();
+        // Sphere vertices and indices
+        vertexBufferSize = sizeof(SPHERE_VERTICES);
+        indexBufferSize = sizeof(SPHERE_INDICES);
         
         // Sphere vertex buffer
         createBuffer(vertexBufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
@@ -996,7 +1347,7 @@ private:
                      vertexStagingBuffer, vertexStagingBufferMemory);
         
         vkMapMemory(device, vertexStagingBufferMemory, 0, vertexBufferSize, 0, &data);
-        memcpy(data, sphereVertices.data(), (size_t) vertexBufferSize);
+        memcpy(data, SPHERE_VERTICES.data(), (size_t) vertexBufferSize);
         vkUnmapMemory(device, vertexStagingBufferMemory);
         
         createBuffer(vertexBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
@@ -1013,7 +1364,7 @@ private:
                      indexStagingBuffer, indexStagingBufferMemory);
         
         vkMapMemory(device, indexStagingBufferMemory, 0, indexBufferSize, 0, &data);
-        memcpy(data, sphereIndices.data(), (size_t) indexBufferSize);
+        memcpy(data, SPHERE_INDICES.data(), (size_t) indexBufferSize);
         vkUnmapMemory(device, indexStagingBufferMemory);
         
         createBuffer(indexBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
@@ -1024,12 +1375,9 @@ private:
         vkDestroyBuffer(device, indexStagingBuffer, nullptr);
         vkFreeMemory(device, indexStagingBufferMemory, nullptr);
         
-        // Create field vertices and indices
-        auto fieldVertices = createFieldVertices();
-        auto fieldIndices = createFieldIndices();
-        
-        vertexBufferSize = sizeof(fieldVertices[0]) * fieldVertices.size();
-        indexBufferSize = sizeof(fieldIndices[0]) * fieldIndices.size();
+        // Field vertices and indices
+        vertexBufferSize = sizeof(FIELD_VERTICES);
+        indexBufferSize = sizeof(FIELD_INDICES);
         
         // Field vertex buffer
         createBuffer(vertexBufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
@@ -1037,7 +1385,7 @@ private:
                      vertexStagingBuffer, vertexStagingBufferMemory);
         
         vkMapMemory(device, vertexStagingBufferMemory, 0, vertexBufferSize, 0, &data);
-        memcpy(data, fieldVertices.data(), (size_t) vertexBufferSize);
+        memcpy(data, FIELD_VERTICES.data(), (size_t) vertexBufferSize);
         vkUnmapMemory(device, vertexStagingBufferMemory);
         
         createBuffer(vertexBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
@@ -1054,7 +1402,7 @@ private:
                      indexStagingBuffer, indexStagingBufferMemory);
         
         vkMapMemory(device, indexStagingBufferMemory, 0, indexBufferSize, 0, &data);
-        memcpy(data, fieldIndices.data(), (size_t) indexBufferSize);
+        memcpy(data, FIELD_INDICES.data(), (size_t) indexBufferSize);
         vkUnmapMemory(device, indexStagingBufferMemory);
         
         createBuffer(indexBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
@@ -1099,7 +1447,7 @@ private:
     }
 
     void createDescriptorSets() {
-        std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, pipelineLayout);
+        std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, descriptorSetLayout);
         VkDescriptorSetAllocateInfo allocInfo{};
         allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
         allocInfo.descriptorPool = descriptorPool;
@@ -1166,47 +1514,65 @@ private:
     }
 
     void initGame() {
-        // Initialize players
-        std::mt19937 rng(std::random_device{}());
-        std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
-        
-        // Red team (left side)
-        for (int i = 0; i < PLAYERS_PER_TEAM; i++) {
-            float x = -FIELD_WIDTH/4 + dist(rng);
-            float z = (i - PLAYERS_PER_TEAM/2) * 2.0f + dist(rng);
-            players.push_back({
-                {x, PLAYER_SIZE/2, z},
-                {0.0f, 0.0f, 0.0f},
-                {1.0f, 0.0f, 0.0f, 1.0f},  // Red
-                0,
-                PLAYER_SIZE,
-                false
-            });
-        }
-        
-        // Blue team (right side)
-        for (int i = 0; i < PLAYERS_PER_TEAM; i++) {
-            float x = FIELD_WIDTH/4 + dist(rng);
-            float z = (i - PLAYERS_PER_TEAM/2) * 2.0f + dist(rng);
-            players.push_back({
-                {x, PLAYER_SIZE/2, z},
-                {0.0f, 0.0f, 0.0f},
-                {0.0f, 0.0f, 1.0f, 1.0f},  // Blue
-                1,
-                PLAYER_SIZE,
-                false
-            });
+        // Line both teams up in their formations
+        formations = loadFormations(FORMATIONS_PATH);
+        const char* teamFormations[2] = {HOME_FORMATION, AWAY_FORMATION};
+        for (int team = 0; team < 2; team++) {
+            teamShapes[team].init(findFormation(formations, teamFormations[team]), team, team * PLAYERS_PER_TEAM);
+            for (int i = 0; i < PLAYERS_PER_TEAM; i++) {
+                Vec2 spot = teamShapes[team].kickoffPosition(i);
+                players.push_back({
+                    {spot.x, PLAYER_SIZE/2, spot.y},
+                    {0.0f, 0.0f, 0.0f},
+                    TEAM_COLORS[team],
+                    team,
+                    PLAYER_SIZE,
+                    false
+                });
+            }
         }
         
         // Initialize ball
-        ball = {
-            {0.0f, BALL_RADIUS, 0.0f},
-            {0.0f, 0.0f, 0.0f},
-            BALL_RADIUS,
-            true
-        };
+        ball = kickoffBall();
+        
+        ai.init(BEHAVIOR_TREE_PATH, players);
+        
+        playerGrid.configure(-FIELD_WIDTH / 2, -FIELD_HEIGHT / 2, FIELD_WIDTH / 2, FIELD_HEIGHT / 2, PLAYER_PICK_RADIUS);
+        indexPlayers();
         
         lastTime = std::chrono::high_resolution_clock::now();
+        publishSnapshot();
+    }
+
+    // Runs until mainLoop stops it. Sleeping to a fixed rate keeps the
+    // thread from spinning; a step that overruns is not caught up on.
+    void simulationLoop() {
+        auto nextStep = std::chrono::steady_clock::now();
+        while (simRunning.load(std::memory_order_acquire)) {
+            simStep++;
+            applyInputEvents();
+            updatePhysics();
+            indexPlayers();
+            publishSnapshot();
+            
+            nextStep += SIM_STEP_INTERVAL;
+            auto now = std::chrono::steady_clock::now();
+            if (nextStep < now) {
+                nextStep = now;
+            }
+            std::this_thread::sleep_until(nextStep);
+        }
+    }
+
+    void indexPlayers() {
+        playerGrid.build(static_cast<uint32_t>(players.size()), [this](uint32_t i) { return players[i].position; });
+    }
+
+    void publishSnapshot() {
+        SimulationFrame& frame = matchSnapshots.writeBuffer();
+        frame.match = captureSnapshot(players.data(), players.size(), ball);
+        frame.step = simStep;
+        matchSnapshots.publish();
     }
 
     void updatePhysics() {
@@ -1216,126 +1582,134 @@ private:
         
         // Limit delta time to avoid spiral of death
         if (deltaTime > 0.1f) deltaTime = 0.1f;
-        
-        // Update ball physics
-        if (!ball.onGround) {
-            ball.velocity.y += GRAVITY * deltaTime;
-        }
-        
-        ball.position.x += ball.velocity.x * deltaTime;
-        ball.position.y += ball.velocity.y * deltaTime;
-        ball.position.z += ball.velocity.z * deltaTime;
-        
-        // Ground collision
-        if (ball.position.y < ball.radius) {
-            ball.position.y = ball.radius;
-            ball.velocity.y = -ball.velocity.y * BOUNCE_DAMPING;
-            ball.onGround = (fabs(ball.velocity.y) < 0.1f);
-            if (ball.onGround) {
-                ball.velocity.y = 0.0f;
-            }
-        }
-        
-        // Field boundaries collision
-        if (fabs(ball.position.x) > FIELD_WIDTH/2 - ball.radius) {
-            ball.position.x = copysign(FIELD_WIDTH/2 - ball.radius, ball.position.x);
-            ball.velocity.x = -ball.velocity.x * BOUNCE_DAMPING;
-        }
-        if (fabs(ball.position.z) > FIELD_HEIGHT/2 - ball.radius) {
-            ball.position.z = copysign(FIELD_HEIGHT/2 - ball.radius, ball.position.z);
-            ball.velocity.z = -ball.velocity.z * BOUNCE_DAMPING;
-            
-            // Check for goal
-            if (fabs(ball.position.x) < GOAL_WIDTH/2 && ball.position.y < GOAL_DEPTH) {
-                // Goal scored!
-                std::cout << "GOAL!" << std::endl;
-                // Reset ball
-                ball = {{0.0f, BALL_RADIUS, 0.0f}, {0.0f, 0.0f, 0.0f}, BALL_RADIUS, true};
+        if (headless) deltaTime = HEADLESS_STEP;
+        
+        // Keep the team shapes, then player decisions, then the physics step
+        for (int team = 0; team < 2; team++) {
+            teamShapes[team].update(players.data(), ball);
+            for (int i = 0; i < PLAYERS_PER_TEAM; i++) {
+                Vec2 home = teamShapes[team].homeOf(i);
+                ai.setHomePosition(team * PLAYERS_PER_TEAM + i, home.x, home.y);
             }
         }
-        
-        // Friction
-        ball.velocity.x *= FRICTION;
-        ball.velocity.z *= FRICTION;
-        
-        // Player-ball collision
-        for (auto& player : players) {
-            float dx = ball.position.x - player.position.x;
-            float dz = ball.position.z - player.position.z;
-            float distance = sqrt(dx*dx + dz*dz);
-            float minDistance = ball.radius + player.size/2;
-            
-            if (distance < minDistance) {
-                // Collision response
-                float overlap = minDistance - distance;
-                float nx = dx / distance;
-                float nz = dz / distance;
-                
-                // Separate objects
-                ball.position.x += nx * overlap * 0.5f;
-                ball.position.z += nz * overlap * 0.5f;
-                player.position.x -= nx * overlap * 0.5f;
-                player.position.z -= nz * overlap * 0.5f;
-                
-                // Transfer momentum
-                float impulseStrength = 5.0f;
-                ball.velocity.x += nx * impulseStrength;
-                ball.velocity.z += nz * impulseStrength;
-                
-                // Add some upward force
-                ball.velocity.y += 2.0f;
-                ball.onGround = false;
-            }
+        prediction.update(players.data(), players.size(), ball, deltaTime);
+        Vec3 eye;
+        Mat4 view, proj;
+        cameraMatrices(ball.position, eye, view, proj);
+        ai.update(players, ball, Frustum::fromViewProjection(mat4Multiply(proj, view).m), prediction);
+        
+        StepEvents events;
+        stepMatch(players.data(), players.size(), ball, deltaTime, &events);
+        
+        if (events.goalSide != 0) {
+            std::cout << "GOAL!" << std::endl;
+            planKickoff(events.goalSide);
         }
-        
-        // Player-player collision (simple avoidance)
-        for (size_t i = 0; i < players.size(); i++) {
-            for (size_t j = i + 1; j < players.size(); j++) {
-                float dx = players[i].position.x - players[j].position.x;
-                float dz = players[i].position.z - players[j].position.z;
-                float distance = sqrt(dx*dx + dz*dz);
-                float minDistance = players[i].size;
-                
-                if (distance < minDistance && distance > 0.0f) {
-                    float overlap = minDistance - distance;
-                    float nx = dx / distance;
-                    float nz = dz / distance;
-                    
-                    players[i].position.x += nx * overlap * 0.5f;
-                    players[i].position.z += nz * overlap * 0.5f;
-                    players[j].position.x -= nx * overlap * 0.5f;
-                    players[j].position.z -= nz * overlap * 0.5f;
-                }
-            }
+    }
+
+    void planKickoff(int goalSide) {
+        // The team that conceded restarts from the centre spot
+        int team = (goalSide == static_cast<int>(attackDirection(0))) ? 1 : 0;
+        MatchSnapshot snapshot = captureSnapshot(players.data(), players.size(), ball);
+        auto candidates = MonteCarloPlanner::kickFan(team, KICKOFF_CANDIDATES, KICKOFF_SPEED);
+        int best = planner.plan(snapshot, team, candidates, KICKOFF_BUDGET_MICROS);
+        if (best >= 0) {
+            ball.velocity = candidates[best].kickVelocity;
+            ball.onGround = true;
         }
     }
 
-    void updateUniformBuffer(uint32_t currentImage) {
-        static auto startTime = std::chrono::high_resolution_clock::now();
-        auto currentTime = std::chrono::high_resolution_clock::now();
-        float time = std::chrono::duration<float>(currentTime - startTime).count();
-        
-        UniformBufferObject ubo{};
-        
-        // Camera follows ball
-        Vec3 target = ball.position;
-        cameraPos = {
+    // Camera following the ball. Each thread derives it from its own copy of
+    // the ball, so the simulation never reads render state.
+    void cameraMatrices(const Vec3& target, Vec3& eye, Mat4& view, Mat4& proj) const {
+        eye = {
             target.x,
             15.0f,
             target.z + 25.0f
         };
         
-        ubo.view = lookAt(cameraPos, target, {0.0f, 1.0f, 0.0f});
-        ubo.proj = perspective(glm::radians(45.0f), 
-                              swapChainExtent.width / (float) swapChainExtent.height, 
-                              0.1f, 100.0f);
+        view = mat4LookAt(eye, target, {0.0f, 1.0f, 0.0f});
+        proj = mat4Perspective(radians(45.0f), 
+                               swapChainExtent.width / (float) swapChainExtent.height, 
+                               0.1f, 100.0f);
         
         // Flip Y axis for Vulkan
-        ubo.proj.m[5] *= -1;
+        proj.m[5] *= -1;
+    }
+
+    void updateUniformBuffer(uint32_t currentImage) {
+        const Ball& ball = frameState->ball;
+        UniformBufferObject ubo{};
+        cameraMatrices(ball.position, cameraPos, ubo.view, ubo.proj);
+        cameraViewProj = mat4Multiply(ubo.proj, ubo.view);
+        cameraInverseValid = mat4Inverse(cameraViewProj, cameraInverseViewProj);
+        
+        // Ball LOD from its projected diameter; behind the camera counts as tiny
+        Vec4 ballClip = mat4Transform(cameraViewProj, {ball.position.x, ball.position.y, ball.position.z, 1.0f});
+        float ballPixels = 0.0f;
+        if (ballClip.w > 0.0f) {
+            ballPixels = ball.radius * std::fabs(ubo.proj.m[5]) * swapChainExtent.height / ballClip.w;
+        }
+        ballLod = selectMeshLod(BALL_LOD_MIN_PIXELS, BALL_LOD_COUNT, ballPixels, ballLod);
         
         memcpy(uniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
     }
 
+    // CPU path: cull players against the camera, sort the survivors nearest
+    // first so early depth testing rejects the ones they hide, then build
+    // their model matrices in one batch and draw them one by one
+    void recordCpuCulledPlayers(VkCommandBuffer commandBuffer, const Frustum& frustum) {
+        size_t count = frameState->playerCount;
+        if (playerCuller.size() != count) {
+            playerCuller.resize(count);
+        }
+        for (size_t i = 0; i < count; i++) {
+            const Player& player = frameState->players[i];
+            playerCuller.setSphere(static_cast<uint32_t>(i), player.position.x, player.position.y, player.position.z,
+                                   player.size * CUBE_BOUNDING_RADIUS);
+        }
+        playerCuller.cull(frustum, &jobs);
+        
+        const std::vector<uint32_t>& visiblePlayers = playerCuller.visible();
+        size_t playerCount = visiblePlayers.size();
+        FrameArena& arena = frameArenas.current();
+        std::pmr::vector<std::pair<float, uint32_t>> playerDrawOrder(playerCount, &arena);   // (view distance², player)
+        for (size_t i = 0; i < playerCount; i++) {
+            const Vec3& p = frameState->players[visiblePlayers[i]].position;
+            Vec3 offset = {p.x - cameraPos.x, p.y - cameraPos.y, p.z - cameraPos.z};
+            playerDrawOrder[i] = {dot(offset, offset), visiblePlayers[i]};
+        }
+        std::sort(playerDrawOrder.begin(), playerDrawOrder.end());
+        
+        std::pmr::vector<float> playerTransformX(playerCount, &arena);
+        std::pmr::vector<float> playerTransformY(playerCount, &arena);
+        std::pmr::vector<float> playerTransformZ(playerCount, &arena);
+        std::pmr::vector<float> playerTransformScale(playerCount, &arena);
+        std::pmr::vector<Mat4> playerModels(playerCount, &arena);
+        for (size_t i = 0; i < playerCount; i++) {
+            const Player& player = frameState->players[playerDrawOrder[i].second];
+            playerTransformX[i] = player.position.x;
+            playerTransformY[i] = player.position.y;
+            playerTransformZ[i] = player.position.z;
+            playerTransformScale[i] = player.size;
+        }
+        mat4TranslateScaleBatch(playerTransformX.data(), playerTransformY.data(), playerTransformZ.data(),
+                                playerTransformScale.data(), playerModels.data(), playerCount);
+        
+        // One pipeline bind per team: its colour is a specialization constant
+        for (int team = 0; team < 2; team++) {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, scenePipelines.get(teamVariant(team)));
+            for (size_t i = 0; i < playerCount; i++) {
+                if (frameState->players[playerDrawOrder[i].second].team != team) {
+                    continue;
+                }
+                vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(Mat4),
+                                   &playerModels[i]);
+                vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(CUBE_INDICES.size()), 1, 0, 0, 0);
+            }
+        }
+    }
+
     void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
         VkCommandBufferBeginInfo beginInfo{};
         beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -1344,56 +1718,90 @@ private:
             throw std::runtime_error("failed to begin recording command buffer!");
         }
         
-        VkRenderPassBeginInfo renderPassInfo{};
-        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        renderPassInfo.renderPass = renderPass;
-        renderPassInfo.framebuffer = swapChainFramebuffers[imageIndex];
-        renderPassInfo.renderArea.offset = {0, 0};
-        renderPassInfo.renderArea.extent = swapChainExtent;
+        uint32_t firstTimestamp = static_cast<uint32_t>(2 * currentFrame);
+        if (timestampPool != VK_NULL_HANDLE) {
+            vkCmdResetQueryPool(commandBuffer, timestampPool, firstTimestamp, 2);
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampPool, firstTimestamp);
+        }
         
-        VkClearValue clearColor = {{{0.1f, 0.1f, 0.1f, 1.0f}}};
-        renderPassInfo.clearValueCount = 1;
-        renderPassInfo.pClearValues = &clearColor;
+        frameFrustum = Frustum::fromViewProjection(cameraViewProj.m);
+        
+        // GPU path: upload every player; the cull passes pick the visible ones
+        if (gpuCulling) {
+            GpuCullInstance* instances = gpuCuller.instances(currentFrame);
+            cullInstanceCount = std::min(frameState->playerCount, gpuCuller.capacity());
+            for (uint32_t i = 0; i < cullInstanceCount; i++) {
+                const Player& player = frameState->players[i];
+                mat4TranslateScaleBatch(&player.position.x, &player.position.y, &player.position.z, &player.size,
+                                        &instances[i].model, 1);
+                instances[i].color = player.color;
+                instances[i].sphere = {player.position.x, player.position.y, player.position.z,
+                                       player.size * CUBE_BOUNDING_RADIUS};
+            }
+        }
+        
+        frameGraph.bindImage(backbufferAttachment, swapChainImages[imageIndex]);
+        frameGraph.setFramebuffer(scenePass, swapChainFramebuffers[imageIndex], swapChainExtent);
+        frameGraph.execute(commandBuffer, &frameArenas.current());
         
-        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+        if (timestampPool != VK_NULL_HANDLE) {
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampPool, firstTimestamp + 1);
+            timestampsWritten[currentFrame] = true;
+        }
         
+        if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to record command buffer!");
+        }
+    }
+
+    // Scene pass: runs inside its subpass of the frame graph's render pass
+    void recordScene(VkCommandBuffer commandBuffer) {
         VkBuffer vertexBuffers[] = {cubeBuffers.vertexBuffer};
         VkDeviceSize offsets[] = {0};
         
-        // Draw field
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &fieldBuffers.vertexBuffer, offsets);
-        vkCmdBindIndexBuffer(commandBuffer, fieldBuffers.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-        
-        UniformBufferObject ubo{};
-        ubo.model = scale(FIELD_WIDTH, 1.0f, FIELD_HEIGHT);
-        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(UniformBufferObject), &ubo);
-        vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(createFieldIndices().size()), 1, 0, 0, 0);
+        // Opaque draws go roughly front to back: players and ball first, the
+        // pitch (which covers most of the screen) last, so its fragments
+        // behind them fail the early depth test instead of being shaded
         
         // Draw players
         vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
         vkCmdBindIndexBuffer(commandBuffer, cubeBuffers.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
         
-        for (const auto& player : players) {
-            ubo.model = multiply(translate(player.position.x, player.position.y, player.position.z),
-                                scale(player.size, player.size, player.size));
-            vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(UniformBufferObject), &ubo);
-            vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(createCubeIndices().size()), 1, 0, 0, 0);
+        if (gpuCulling) {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, instancedPipeline);
+            vkCmdPushConstants(commandBuffer, instancedPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(Mat4),
+                               &cameraViewProj);
+            gpuCuller.recordDraw(commandBuffer, instancedPipelineLayout, static_cast<uint32_t>(currentFrame));
+        }
+        
+        // Everything else takes the camera from this frame's uniform buffer
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1,
+                                &descriptorSets[currentFrame], 0, nullptr);
+        if (!gpuCulling) {
+            recordCpuCulledPlayers(commandBuffer, frameFrustum);
         }
         
         // Draw ball
         vkCmdBindVertexBuffers(commandBuffer, 0, 1, &sphereBuffers.vertexBuffer, offsets);
         vkCmdBindIndexBuffer(commandBuffer, sphereBuffers.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
         
-        ubo.model = translate(ball.position.x, ball.position.y, ball.position.z);
-        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(UniformBufferObject), &ubo);
-        vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(createSphereIndices().size()), 1, 0, 0, 0);
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                          scenePipelines.get(sceneVariant(static_cast<uint32_t>(ballLod))));
+        const Ball& ball = frameState->ball;
+        Mat4 ballModel = mat4Multiply(mat4Translate(ball.position.x, ball.position.y, ball.position.z),
+                                      mat4Scale(ball.radius, ball.radius, ball.radius));
+        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(Mat4), &ballModel);
+        const MeshRange& ballMesh = BALL_LODS.levels[ballLod];
+        vkCmdDrawIndexed(commandBuffer, ballMesh.indexCount, 1, ballMesh.firstIndex, ballMesh.vertexOffset, 0);
         
-        vkCmdEndRenderPass(commandBuffer);
+        // Draw field
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &fieldBuffers.vertexBuffer, offsets);
+        vkCmdBindIndexBuffer(commandBuffer, fieldBuffers.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
         
-        if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
-            throw std::runtime_error("failed to record command buffer!");
-        }
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, scenePipelines.get(sceneVariant()));
+        Mat4 fieldModel = mat4Identity();
+        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(Mat4), &fieldModel);
+        vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(FIELD_INDICES.size()), 1, 0, 0, 0);
     }
 
     void drawFrame() {
@@ -1410,12 +1818,8 @@ private:
             throw std::runtime_error("failed to acquire swap chain image!");
         }
         
-        updateUniformBuffer(currentFrame);
-        
-        vkResetFences(device, 1, &inFlightFences[currentFrame]);
-        
-        vkResetCommandBuffer(commandBuffers[currentFrame], 0);
-        recordCommandBuffer(commandBuffers[currentFrame], imageIndex);
+        LatencyTracker::Sample frameLatency{};
+        bool frameShowsInput = recordFrame(imageIndex, frameLatency);
         
         VkSubmitInfo submitInfo{};
         submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -1435,6 +1839,7 @@ private:
         if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
             throw std::runtime_error("failed to submit draw command buffer!");
         }
+        frameLatency.submitted = std::chrono::steady_clock::now();
         
         VkPresentInfoKHR presentInfo{};
         presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -1446,8 +1851,44 @@ private:
         presentInfo.pSwapchains = swapChains;
         presentInfo.pImageIndices = &imageIndex;
         
+        // Every present gets an id when they are timed; ids only ever grow
+        uint64_t presentId = 0;
+        VkPresentTimeGOOGLE presentTime{};
+        VkPresentTimesInfoGOOGLE presentTimes{};
+        VkPresentIdKHR presentIds{};
+        if (presentTiming == PRESENT_TIMING_DISPLAY_TIMING) {
+            presentId = nextPresentId++;
+            presentTime.presentID = static_cast<uint32_t>(presentId);
+            presentTimes.sType = VK_STRUCTURE_TYPE_PRESENT_TIMES_INFO_GOOGLE;
+            presentTimes.swapchainCount = 1;
+            presentTimes.pTimes = &presentTime;
+            presentInfo.pNext = &presentTimes;
+        } else if (presentTiming == PRESENT_TIMING_PRESENT_WAIT) {
+            presentId = nextPresentId++;
+            presentIds.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+            presentIds.swapchainCount = 1;
+            presentIds.pPresentIds = &presentId;
+            presentInfo.pNext = &presentIds;
+        }
+        
         result = vkQueuePresentKHR(presentQueue, &presentInfo);
         
+        if (frameShowsInput) {
+            if (presentId != 0) {
+                latency.frameSubmitted(presentId, frameLatency);
+                if (presentTiming == PRESENT_TIMING_PRESENT_WAIT && presentWaits.push(presentId)) {
+                    // Taking the lock orders the push before the waiter's check
+                    { std::lock_guard<std::mutex> lock(presentWaitMutex); }
+                    presentWaitWake.notify_one();
+                }
+            } else {
+                latency.frameSubmittedUntimed(frameLatency);
+            }
+        }
+        if (latencyTracking) {
+            collectPresentTimes();
+        }
+        
         if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
             // Handle resize
         } else if (result != VK_SUCCESS) {
@@ -1457,14 +1898,233 @@ private:
         currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
     }
 
+    // The part of a frame the window and headless paths share, once the
+    // slot's fence has signalled: takes the newest snapshot and records the
+    // frame's commands. Returns whether the frame is the first to show some
+    // input, whose latency sample it then fills.
+    bool recordFrame(uint32_t imageIndex, LatencyTracker::Sample& frameLatency) {
+        // The GPU is done with this slot, so is its transient data
+        frameArenas.beginFrame(static_cast<uint32_t>(currentFrame));
+        AllocationScope frameAllocations;
+        
+        // Newest simulation step; the previous one if none finished since
+        matchSnapshots.update();
+        frameState = &matchSnapshots.read().match;
+        updateUniformBuffer(currentFrame);
+        
+        bool frameShowsInput = latencyTracking && takeAppliedInput(matchSnapshots.read().step, frameLatency);
+        
+        vkResetFences(device, 1, &inFlightFences[currentFrame]);
+        
+        vkResetCommandBuffer(commandBuffers[currentFrame], 0);
+        recordCommandBuffer(commandBuffers[currentFrame], imageIndex);
+        
+        // Driver calls are left out: only the engine's own frame work should
+        // stay off the heap
+        if (FRAME_ALLOCATION_TRACKING && frameNumber >= ALLOCATION_WARMUP_FRAMES && frameAllocations.count() > 0) {
+            std::cerr << "frame " << frameNumber << ": " << frameAllocations.count()
+                      << " heap allocations while recording" << std::endl;
+            allocatingFrames++;
+        }
+        frameNumber++;
+        return frameShowsInput;
+    }
+
+    // Headless frame: the slot's own offscreen image, no acquire or present.
+    // Recording covers everything from taking the snapshot to the finished
+    // command buffer; submit is the vkQueueSubmit call alone.
+    void drawOffscreenFrame() {
+        vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+        collectGpuTime(currentFrame);
+        bool timed = frameNumber >= HEADLESS_WARMUP_FRAMES;
+        
+        auto recordStart = std::chrono::steady_clock::now();
+        LatencyTracker::Sample frameLatency{};
+        recordFrame(static_cast<uint32_t>(currentFrame), frameLatency);
+        auto recordEnd = std::chrono::steady_clock::now();
+        
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
+        if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit draw command buffer!");
+        }
+        auto submitEnd = std::chrono::steady_clock::now();
+        
+        if (timed) {
+            recordTimes.add(recordEnd - recordStart);
+            submitTimes.add(submitEnd - recordEnd);
+        } else {
+            timestampsWritten[currentFrame] = false;   // Warm-up frame: its GPU time is not counted either
+        }
+        currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    }
+
+    // After the slot's fence: the GPU time of the frame it last ran
+    void collectGpuTime(size_t frame) {
+        if (!timestampsWritten[frame]) {
+            return;
+        }
+        timestampsWritten[frame] = false;
+        uint64_t timestamps[2];
+        if (vkGetQueryPoolResults(device, timestampPool, static_cast<uint32_t>(2 * frame), 2, sizeof(timestamps),
+                                  timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+            return;
+        }
+        uint64_t ticks = ((timestamps[1] & timestampMask) - (timestamps[0] & timestampMask)) & timestampMask;
+        gpuTimes.add(std::chrono::nanoseconds(static_cast<int64_t>(ticks * static_cast<double>(timestampPeriod))));
+    }
+
+    // The match plays itself: stepped inline before every frame instead of
+    // on the simulation thread, so each frame shows exactly one fixed step
+    // and every run renders the same match
+    void headlessLoop() {
+        recordTimes.reserve(headlessFrames);
+        submitTimes.reserve(headlessFrames);
+        gpuTimes.reserve(headlessFrames);
+        
+        uint64_t drawnPlayers = 0;
+        uint64_t culledPlayers = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t frame = 0; frame < HEADLESS_WARMUP_FRAMES + headlessFrames; frame++) {
+            if (frame == HEADLESS_WARMUP_FRAMES) {
+                start = std::chrono::steady_clock::now();
+            }
+            simStep++;
+            updatePhysics();
+            indexPlayers();
+            publishSnapshot();
+            drawOffscreenFrame();
+            if (frame >= HEADLESS_WARMUP_FRAMES && !gpuCulling) {
+                drawnPlayers += playerCuller.drawnCount;
+                culledPlayers += playerCuller.culledCount;
+            }
+        }
+        vkDeviceWaitIdle(device);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+            collectGpuTime(i);
+        }
+        
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        std::cout << properties.deviceName << ", " << swapChainExtent.width << "x" << swapChainExtent.height << ", "
+                  << headlessFrames << " frames in " << seconds << " s (" << headlessFrames / seconds << " fps)"
+                  << (gpuCulling ? ", GPU culling" : "") << std::endl;
+        recordTimes.print(std::cout, "cpu record");
+        submitTimes.print(std::cout, "submit");
+        if (timestampPool != VK_NULL_HANDLE) {
+            gpuTimes.print(std::cout, "gpu");
+        }
+        // The GPU path counts visible instances on the GPU and never reads them back
+        if (!gpuCulling) {
+            std::cout << "players per frame: " << static_cast<double>(drawnPlayers) / headlessFrames << " drawn, "
+                      << static_cast<double>(culledPlayers) / headlessFrames << " culled" << std::endl;
+        }
+    }
+
+    // Oldest input applied by the steps up to the one this frame shows;
+    // inputs of steps no frame showed carry over to this one
+    bool takeAppliedInput(uint64_t step, LatencyTracker::Sample& sample) {
+        bool found = false;
+        while (const AppliedInput* next = appliedInputs.peek()) {
+            if (next->step > step) {
+                break;
+            }
+            if (!found) {
+                sample.input = next->input;
+                sample.simulated = next->simulated;
+                found = true;
+            }
+            AppliedInput done;
+            if (!appliedInputs.pop(done)) {
+                break;
+            }
+        }
+        return found;
+    }
+
+    // Display timing and present-wait times use CLOCK_MONOTONIC, which is
+    // steady_clock on Linux and Android
+    void collectPresentTimes() {
+        if (presentTiming == PRESENT_TIMING_DISPLAY_TIMING) {
+            VkPastPresentationTimingGOOGLE timings[8];
+            uint32_t count = 8;
+            getPastPresentationTiming(device, swapChain, &count, timings);
+            for (uint32_t i = 0; i < count; i++) {
+                auto presented = std::chrono::steady_clock::time_point(std::chrono::nanoseconds(timings[i].actualPresentTime));
+                latency.framePresented(timings[i].presentID, presented);
+            }
+        } else if (presentTiming == PRESENT_TIMING_PRESENT_WAIT) {
+            PresentedFrame presented;
+            while (presentedFrames.pop(presented)) {
+                latency.framePresented(presented.presentId, presented.time);
+            }
+        }
+    }
+
+    // Waits for each timed frame in turn. Frames reach the display in
+    // order, so by the time one wait returns the next frame has usually not
+    // been shown yet and its wait blocks too. A wait that times out (the
+    // frame was never shown) drops the frame.
+    void presentWaitLoop() {
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(presentWaitMutex);
+                presentWaitWake.wait(lock, [this] { return !presentWaitRunning || presentWaits.peek() != nullptr; });
+                if (!presentWaitRunning) {
+                    return;
+                }
+            }
+            uint64_t presentId;
+            while (presentWaits.pop(presentId)) {
+                VkResult result = waitForPresent(device, swapChain, presentId, PRESENT_WAIT_TIMEOUT_NS);
+                auto presented = std::chrono::steady_clock::now();
+                if (result == VK_SUCCESS && !presentedFrames.push({presentId, presented})) {
+                    break;   // The render thread is behind; the frame drops out of the statistics
+                }
+            }
+        }
+    }
+
+    void startPresentWait() {
+        presentWaitRunning = true;
+        presentWaitThread = std::thread(&VulkanSoccerEngine::presentWaitLoop, this);
+    }
+
+    void stopPresentWait() {
+        {
+            std::lock_guard<std::mutex> lock(presentWaitMutex);
+            presentWaitRunning = false;
+        }
+        presentWaitWake.notify_one();
+        presentWaitThread.join();
+    }
+
     void mainLoop() {
+        simRunning.store(true, std::memory_order_release);
+        simThread = std::thread(&VulkanSoccerEngine::simulationLoop, this);
+        if (presentTiming == PRESENT_TIMING_PRESENT_WAIT) {
+            startPresentWait();
+        }
+        
         while (!glfwWindowShouldClose(window)) {
             glfwPollEvents();
-            updatePhysics();
             drawFrame();
         }
         
+        simRunning.store(false, std::memory_order_release);
+        simThread.join();
         vkDeviceWaitIdle(device);
+        if (presentTiming == PRESENT_TIMING_PRESENT_WAIT) {
+            stopPresentWait();
+        }
+        
+        if (latencyTracking) {
+            collectPresentTimes();
+            latency.print(std::cout);
+        }
     }
 
     void cleanup() {
@@ -1490,18 +2150,43 @@ private:
         }
         
         vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-        vkDestroyPipeline(device, graphicsPipeline, nullptr);
+        vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+        if (gpuCulling) {
+            vkDestroyPipeline(device, instancedPipeline, nullptr);
+            vkDestroyPipelineLayout(device, instancedPipelineLayout, nullptr);
+            gpuCuller.destroy();
+        }
+        scenePipelines.destroy();
+        vkDestroyShaderModule(device, sceneFragModule, nullptr);
+        vkDestroyShaderModule(device, sceneVertModule, nullptr);
         vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
-        vkDestroyRenderPass(device, renderPass, nullptr);
+        frameGraph.destroyRenderPasses(device);
         
         for (auto framebuffer : swapChainFramebuffers) {
             vkDestroyFramebuffer(device, framebuffer, nullptr);
         }
         
+        vkDestroyImageView(device, depthImageView, nullptr);
+        vkDestroyImage(device, depthImage, nullptr);
+        vkFreeMemory(device, depthImageMemory, nullptr);
+        
         for (auto imageView : swapChainImageViews) {
             vkDestroyImageView(device, imageView, nullptr);
         }
         
+        if (headless) {
+            for (size_t i = 0; i < swapChainImages.size(); i++) {
+                vkDestroyImage(device, swapChainImages[i], nullptr);
+                vkFreeMemory(device, offscreenImageMemory[i], nullptr);
+            }
+            if (timestampPool != VK_NULL_HANDLE) {
+                vkDestroyQueryPool(device, timestampPool, nullptr);
+            }
+            vkDestroyDevice(device, nullptr);
+            vkDestroyInstance(instance, nullptr);
+            return;
+        }
+        
         vkDestroySwapchainKHR(device, swapChain, nullptr);
         vkDestroyDevice(device, nullptr);
         vkDestroySurfaceKHR(instance, surface, nullptr);
@@ -1523,38 +2208,3 @@ int main() {
     
     return EXIT_SUCCESS;
 }
-
-
-This Vulkan soccer game engine includes:
-
-**Key Features:**
-1. **Programmatic Rendering**: All geometry (cubes, sphere, field) generated with vertex arrays
-2. **Physics System**: Realistic ball movement, gravity, friction, and collision
-3. **Touch Controls**: Click/touch to select and move players
-4. **Vulkan Pipeline**: Complete Vulkan setup from instance to swap chain
-5. **Camera System**: Follows the ball with perspective projection
-6. **Goal Detection**: Scores when ball enters goal areas
-
-**Game Elements:**
-- Green soccer pitch with white markings
-- 22 players (11 red, 11 blue) as cubes
-- White sphere as soccer ball
-- Field boundaries and goal detection
-
-**Physics Simulation:**
-- Gravity affecting the ball
-- Bounce damping on collisions
-- Player-ball interaction
-- Friction slowing movement
-
-**Controls:**
-- Click/tap to select nearest player
-- Drag to move selected player
-- Players automatically interact with ball
-
-**To compile and run:**
-1. Install Vulkan SDK
-2. Compile with Vulkan and GLFW libraries
-3. Run on Vulkan-compatible system
-
-The engine handles all rendering internally without external assets, using mathematical generation for all game objects.
\ No newline at end of file
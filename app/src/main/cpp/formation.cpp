@@ -0,0 +1,211 @@
+#include "formation.h"
+#include "asset_path.h"
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+std::vector<Formation> loadFormations(const std::string& relativePath) {
+    std::string path = assetPath(relativePath);
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("failed to open formations " + path);
+    }
+
+    std::vector<Formation> formations;
+    std::string line;
+    int lineNumber = 0;
+
+    auto fail = [&](const std::string& message) {
+        throw std::runtime_error(path + " line " + std::to_string(lineNumber) + ": " + message);
+    };
+
+    auto finish = [&]() {
+        if (!formations.empty() && formations.back().slots.size() != PLAYERS_PER_TEAM) {
+            fail("formation " + formations.back().name + " needs " +
+                 std::to_string(PLAYERS_PER_TEAM) + " slots");
+        }
+    };
+
+    while (std::getline(file, line)) {
+        lineNumber++;
+
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+
+        std::istringstream tokens(line);
+        std::string keyword;
+        if (!(tokens >> keyword)) {
+            continue;
+        }
+
+        if (keyword == "formation") {
+            finish();
+            Formation formation;
+            if (!(tokens >> formation.name)) {
+                fail("formation without a name");
+            }
+            formations.push_back(formation);
+            continue;
+        }
+
+        if (formations.empty()) {
+            fail("slot outside of a formation");
+        }
+
+        FormationSlot slot;
+        slot.role = keyword;
+        if (!(tokens >> slot.across >> slot.depth >> slot.mobility)) {
+            fail("expected <role> <across> <depth> <mobility>");
+        }
+        formations.back().slots.push_back(slot);
+    }
+    finish();
+
+    if (formations.empty()) {
+        throw std::runtime_error("no formations in " + path);
+    }
+    return formations;
+}
+
+const Formation& findFormation(const std::vector<Formation>& formations, const std::string& name) {
+    for (const Formation& formation : formations) {
+        if (formation.name == name) {
+            return formation;
+        }
+    }
+    throw std::runtime_error("unknown formation " + name);
+}
+
+void AuctionAssigner::resize(int n) {
+    size = n;
+    prices.assign(n, 0.0f);
+    owner.assign(n, -1);
+    assigned.assign(n, -1);
+    queue.clear();
+    queue.reserve(n);
+}
+
+void AuctionAssigner::solve(const float* benefit) {
+    int n = size;
+    queue.clear();
+    lastBids = 0;
+
+    // Warm start: keep every assignment that is still within keepTolerance of
+    // the person's best option at current prices, release the rest
+    for (int i = 0; i < n; i++) {
+        int j = assigned[i];
+        if (j < 0) {
+            queue.push_back(i);
+            continue;
+        }
+        const float* row = benefit + i * n;
+        float best = -std::numeric_limits<float>::max();
+        for (int k = 0; k < n; k++) {
+            best = std::max(best, row[k] - prices[k]);
+        }
+        if (row[j] - prices[j] < best - std::max(epsilon, keepTolerance)) {
+            owner[j] = -1;
+            assigned[i] = -1;
+            queue.push_back(i);
+        }
+    }
+
+    // Gauss-Seidel bidding: each free person bids for its best object and
+    // raises that object's price by its margin over the second best
+    while (!queue.empty()) {
+        int i = queue.back();
+        queue.pop_back();
+
+        const float* row = benefit + i * n;
+        int bestObject = 0;
+        float best = -std::numeric_limits<float>::max();
+        float second = -std::numeric_limits<float>::max();
+        for (int k = 0; k < n; k++) {
+            float value = row[k] - prices[k];
+            if (value > best) {
+                second = best;
+                best = value;
+                bestObject = k;
+            } else if (value > second) {
+                second = value;
+            }
+        }
+        if (n == 1) {
+            second = best;
+        }
+
+        prices[bestObject] += best - second + epsilon;
+        if (owner[bestObject] >= 0) {
+            assigned[owner[bestObject]] = -1;
+            queue.push_back(owner[bestObject]);
+        }
+        owner[bestObject] = i;
+        assigned[i] = bestObject;
+        lastBids++;
+    }
+
+    // Prices only ever rise; rebase them so they stay small
+    float lowest = *std::min_element(prices.begin(), prices.end());
+    for (float& price : prices) {
+        price -= lowest;
+    }
+}
+
+void TeamShape::init(const Formation& formation, int team, int firstPlayer) {
+    this->formation = formation;
+    this->team = team;
+    this->firstPlayer = firstPlayer;
+
+    int n = static_cast<int>(formation.slots.size());
+    slotPosition.resize(n);
+    benefit.resize(static_cast<size_t>(n) * n);
+    assigner.resize(n);
+
+    // Start with player k in slot k
+    for (int k = 0; k < n; k++) {
+        slotPosition[k] = kickoffPosition(k);
+    }
+}
+
+Vec2 TeamShape::slotWorld(const FormationSlot& slot, float ballAcross, float ballDepth) const {
+    float across = slot.across * FORMATION_ACROSS_SQUEEZE + slot.mobility * ballAcross * FORMATION_ACROSS_SHIFT;
+    float depth = slot.depth + slot.mobility * (ballDepth - 0.5f) * FORMATION_DEPTH_SHIFT;
+    across = std::clamp(across, -0.95f, 0.95f);
+    depth = std::clamp(depth, 0.02f, 0.98f);
+
+    float direction = attackDirection(team);
+    return {across * FIELD_WIDTH/2 * direction, (depth - 0.5f) * FIELD_HEIGHT * direction};
+}
+
+Vec2 TeamShape::kickoffPosition(int slot) const {
+    return slotWorld(formation.slots[slot], 0.0f, 0.5f);
+}
+
+void TeamShape::update(const Player* players, const Ball& ball) {
+    int n = static_cast<int>(formation.slots.size());
+    float direction = attackDirection(team);
+    float ballAcross = ball.position.x / (FIELD_WIDTH/2) * direction;
+    float ballDepth = ball.position.z * direction / FIELD_HEIGHT + 0.5f;
+
+    for (int j = 0; j < n; j++) {
+        slotPosition[j] = slotWorld(formation.slots[j], ballAcross, ballDepth);
+    }
+
+    // Benefit is the negated squared distance from player to slot
+    for (int i = 0; i < n; i++) {
+        const Vec3& p = players[firstPlayer + i].position;
+        float* row = benefit.data() + i * n;
+        for (int j = 0; j < n; j++) {
+            float dx = slotPosition[j].x - p.x;
+            float dz = slotPosition[j].y - p.z;
+            row[j] = -(dx*dx + dz*dz);
+        }
+    }
+
+    assigner.solve(benefit.data());
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "simulation.h"
+
+#include <string>
+#include <vector>
+
+// Slot coordinates are team-relative: across runs -1..1 between the
+// touchlines, depth runs 0..1 from the team's own goal line to the
+// opponent's (see assets/formations/formations.txt).
+struct FormationSlot {
+    std::string role;
+    float across;
+    float depth;
+    float mobility;   // How far the slot follows the ball, 0..1
+};
+
+struct Formation {
+    std::string name;
+    std::vector<FormationSlot> slots;
+};
+
+// path is relative to the asset root (see asset_path.h)
+std::vector<Formation> loadFormations(const std::string& path);
+const Formation& findFormation(const std::vector<Formation>& formations, const std::string& name);
+
+// How strongly moving slots follow the ball
+const float FORMATION_DEPTH_SHIFT = 0.6f;
+const float FORMATION_ACROSS_SHIFT = 0.3f;
+const float FORMATION_ACROSS_SQUEEZE = 0.85f;
+
+// Incremental auction solver for square assignment problems (Bertsekas).
+// Prices and the previous assignment are kept between calls, so when the
+// benefits only drift a little from tick to tick, only the few persons whose
+// slot stopped being nearly-best have to bid again.
+class AuctionAssigner {
+public:
+    void resize(int n);
+
+    // benefit[i * n + j] is the value of giving object j to person i
+    void solve(const float* benefit);
+
+    int objectOf(int person) const { return assigned[person]; }
+    uint32_t lastBids = 0;
+
+    float epsilon = 0.01f;
+    float keepTolerance = 0.5f;   // Slack before a warm-started assignment is re-bid
+
+private:
+    int size = 0;
+    std::vector<float> prices;
+    std::vector<int> owner;      // Object -> person, -1 if free
+    std::vector<int> assigned;   // Person -> object, -1 if unassigned
+    std::vector<int> queue;
+};
+
+// Keeps one team in shape: moves the formation slots with the ball and
+// re-assigns players to slots every tick.
+class TeamShape {
+public:
+    void init(const Formation& formation, int team, int firstPlayer);
+
+    // Slot positions with the ball on the centre spot
+    Vec2 kickoffPosition(int slot) const;
+
+    void update(const Player* players, const Ball& ball);
+
+    // Current target for the k-th player of the team
+    Vec2 homeOf(int k) const { return slotPosition[assigner.objectOf(k)]; }
+
+    const AuctionAssigner& solver() const { return assigner; }
+
+private:
+    Vec2 slotWorld(const FormationSlot& slot, float ballAcross, float ballDepth) const;
+
+    Formation formation;
+    int team = 0;
+    int firstPlayer = 0;
+    std::vector<Vec2> slotPosition;
+    std::vector<float> benefit;
+    AuctionAssigner assigner;
+};
@@ -0,0 +1,62 @@
+#include "frame_arena.h"
+
+#include <new>
+
+// Block alignment, and the largest alignment served from the block
+const size_t FRAME_ARENA_ALIGNMENT = alignof(std::max_align_t) > 64 ? alignof(std::max_align_t) : 64;
+
+FrameArena::FrameArena(size_t capacity) {
+    size = capacity;
+    block = static_cast<std::byte*>(::operator new(size, std::align_val_t(FRAME_ARENA_ALIGNMENT)));
+}
+
+FrameArena::~FrameArena() {
+    releaseOverflow();
+    ::operator delete(block, std::align_val_t(FRAME_ARENA_ALIGNMENT));
+}
+
+void FrameArena::reset() {
+    if (!overflow.empty()) {
+        size_t highWater = offset + overflowBytes;
+        releaseOverflow();
+        ::operator delete(block, std::align_val_t(FRAME_ARENA_ALIGNMENT));
+        size = highWater + highWater / 2;
+        block = static_cast<std::byte*>(::operator new(size, std::align_val_t(FRAME_ARENA_ALIGNMENT)));
+    }
+    offset = 0;
+}
+
+void* FrameArena::do_allocate(size_t bytes, size_t alignment) {
+    if (alignment <= FRAME_ARENA_ALIGNMENT) {
+        size_t start = (offset + alignment - 1) & ~(alignment - 1);
+        if (start + bytes <= size) {
+            offset = start + bytes;
+            return block + start;
+        }
+    }
+
+    void* pointer = ::operator new(bytes, std::align_val_t(alignment));
+    overflow.push_back({pointer, alignment});
+    overflowBytes += bytes + alignment;
+    return pointer;
+}
+
+void FrameArena::releaseOverflow() {
+    for (const Overflow& allocation : overflow) {
+        ::operator delete(allocation.pointer, std::align_val_t(allocation.alignment));
+    }
+    overflow.clear();
+    overflowBytes = 0;
+}
+
+FrameArenaRing::FrameArenaRing(uint32_t frames, size_t capacity) {
+    for (uint32_t i = 0; i < frames; i++) {
+        arenas.push_back(std::make_unique<FrameArena>(capacity));
+    }
+}
+
+FrameArena& FrameArenaRing::beginFrame(uint32_t frame) {
+    currentFrame = frame;
+    arenas[frame]->reset();
+    return *arenas[frame];
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+// Linear (bump) allocator for data that lives for one frame. Allocation is a
+// pointer bump, deallocation does nothing, and reset() drops everything at
+// once. Use it through std::pmr containers:
+//
+//     std::pmr::vector<Mat4> models(&arena);
+//
+// When a frame needs more than the block holds, the rest comes from the heap
+// and is freed by the next reset(), which also grows the block to that
+// frame's high-water mark, so steady-state frames never reach the heap.
+class FrameArena : public std::pmr::memory_resource {
+public:
+    explicit FrameArena(size_t capacity);
+    ~FrameArena() override;
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void reset();
+
+    size_t used() const { return offset + overflowBytes; }
+    size_t capacity() const { return size; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+    struct Overflow {
+        void* pointer;
+        size_t alignment;
+    };
+
+    void releaseOverflow();
+
+    std::byte* block = nullptr;
+    size_t size = 0;
+    size_t offset = 0;
+    std::vector<Overflow> overflow;   // Heap allocations of the current frame
+    size_t overflowBytes = 0;
+};
+
+// One arena per frame in flight. beginFrame() resets the slot whose fence
+// was just waited on, so anything allocated while recording a frame (data a
+// command buffer points at included) stays valid until the GPU is done with
+// that frame.
+class FrameArenaRing {
+public:
+    FrameArenaRing(uint32_t frames, size_t capacity);
+
+    FrameArena& beginFrame(uint32_t frame);
+    FrameArena& current() { return *arenas[currentFrame]; }
+
+private:
+    std::vector<std::unique_ptr<FrameArena>> arenas;
+    uint32_t currentFrame = 0;
+};
@@ -0,0 +1,747 @@
+#include "frame_graph.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+const VkPipelineStageFlags ATTACHMENT_WRITE_STAGES = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                                                     VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                                                     VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+const VkAccessFlags ATTACHMENT_WRITE_ACCESS = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                              VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+VkPipelineStageFlags writeStages(const FrameGraphAttachment& attachment) {
+    return attachment.depth ? VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT
+                            : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+}
+
+VkAccessFlags writeAccess(const FrameGraphAttachment& attachment) {
+    return attachment.depth ? VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT : VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+}
+
+// Attachment writes may blend or depth test against what is there
+VkAccessFlags outputAccess(const FrameGraphAttachment& attachment) {
+    return attachment.depth ? VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+                            : VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+}
+
+struct BufferUse {
+    VkPipelineStageFlags stages;
+    VkAccessFlags access;
+    bool write;
+};
+
+BufferUse bufferUse(FrameGraphBufferUsage usage) {
+    switch (usage) {
+        case FRAME_GRAPH_TRANSFER_WRITE:
+            return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, true};
+        case FRAME_GRAPH_COMPUTE_READ:
+            return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, false};
+        case FRAME_GRAPH_COMPUTE_WRITE:
+            return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, true};
+        case FRAME_GRAPH_INDIRECT_READ:
+            return {VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, false};
+        case FRAME_GRAPH_VERTEX_SHADER_READ:
+            return {VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, false};
+    }
+    return {0, 0, false};
+}
+
+// Dependencies between the same two subpasses are merged into one
+void addDependency(std::vector<VkSubpassDependency>& dependencies, uint32_t src, uint32_t dst,
+                   VkPipelineStageFlags srcStages, VkAccessFlags srcAccess,
+                   VkPipelineStageFlags dstStages, VkAccessFlags dstAccess) {
+    for (VkSubpassDependency& dependency : dependencies) {
+        if (dependency.srcSubpass == src && dependency.dstSubpass == dst) {
+            dependency.srcStageMask |= srcStages;
+            dependency.srcAccessMask |= srcAccess;
+            dependency.dstStageMask |= dstStages;
+            dependency.dstAccessMask |= dstAccess;
+            return;
+        }
+    }
+    VkSubpassDependency dependency{};
+    dependency.srcSubpass = src;
+    dependency.dstSubpass = dst;
+    dependency.srcStageMask = srcStages;
+    dependency.srcAccessMask = srcAccess;
+    dependency.dstStageMask = dstStages;
+    dependency.dstAccessMask = dstAccess;
+    // Subpasses only ever read the pixel they shade
+    if (src != VK_SUBPASS_EXTERNAL) {
+        dependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+    }
+    dependencies.push_back(dependency);
+}
+
+// What a resource was last used for, to derive the next barrier
+struct AccessState {
+    VkPipelineStageFlags writeStages = 0;
+    VkAccessFlags writeAccess = 0;
+    VkPipelineStageFlags readStages = 0;      // Reads since the last write
+    VkPipelineStageFlags visibleStages = 0;   // Stages the last write was made visible to
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    bool touched = false;
+};
+
+}  // namespace
+
+VkRenderPassCreateInfo FrameGraphRenderPass::createInfo() const {
+    VkRenderPassCreateInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    info.attachmentCount = static_cast<uint32_t>(attachments.size());
+    info.pAttachments = attachments.data();
+    info.subpassCount = static_cast<uint32_t>(subpasses.size());
+    info.pSubpasses = subpasses.data();
+    info.dependencyCount = static_cast<uint32_t>(dependencies.size());
+    info.pDependencies = dependencies.data();
+    return info;
+}
+
+uint32_t FrameGraph::addAttachment(const FrameGraphAttachment& attachment) {
+    attachments.push_back(attachment);
+    images.push_back(VK_NULL_HANDLE);
+    return static_cast<uint32_t>(attachments.size() - 1);
+}
+
+uint32_t FrameGraph::addBuffer(bool external) {
+    externalBuffers.push_back(external);
+    return static_cast<uint32_t>(externalBuffers.size() - 1);
+}
+
+uint32_t FrameGraph::addPass(FrameGraphPass pass) {
+    passes.push_back(std::move(pass));
+    return static_cast<uint32_t>(passes.size() - 1);
+}
+
+bool FrameGraph::writes(const FrameGraphPass& pass, uint32_t attachment) const {
+    return pass.depthOutput == static_cast<int32_t>(attachment) ||
+           std::find(pass.colorOutputs.begin(), pass.colorOutputs.end(), attachment) != pass.colorOutputs.end();
+}
+
+bool FrameGraph::reads(const FrameGraphPass& pass, uint32_t attachment) const {
+    return std::find(pass.inputs.begin(), pass.inputs.end(), attachment) != pass.inputs.end();
+}
+
+bool FrameGraph::isGraphics(const FrameGraphPass& pass) const {
+    return !pass.colorOutputs.empty() || !pass.inputs.empty() || pass.depthOutput != FRAME_GRAPH_NONE;
+}
+
+int32_t FrameGraph::stepOf(uint32_t pass) const {
+    for (size_t s = 0; s < steps.size(); s++) {
+        const std::vector<uint32_t>& stepPasses = steps[s].passes;
+        if (std::find(stepPasses.begin(), stepPasses.end(), pass) != stepPasses.end()) {
+            return static_cast<int32_t>(s);
+        }
+    }
+    return FRAME_GRAPH_NONE;
+}
+
+void FrameGraph::compile() {
+    cullPasses();
+    buildSteps();
+    aliasPredecessor.assign(attachments.size(), FRAME_GRAPH_NONE);
+    buildBarriers();
+}
+
+// Walks the passes backwards from the external resources: a pass survives
+// if it has side effects or writes something a surviving pass (or the
+// outside world) reads. Attachment writes keep earlier writers alive, since
+// they may load, blend over or depth test against their results.
+void FrameGraph::cullPasses() {
+    std::vector<bool> neededImages(attachments.size());
+    for (size_t a = 0; a < attachments.size(); a++) {
+        neededImages[a] = attachments[a].external;
+    }
+    std::vector<bool> neededBuffers = externalBuffers;
+    alive.assign(passes.size(), false);
+
+    for (size_t p = passes.size(); p-- > 0;) {
+        const FrameGraphPass& pass = passes[p];
+        bool live = pass.sideEffects;
+        for (uint32_t a = 0; a < attachments.size() && !live; a++) {
+            live = writes(pass, a) && neededImages[a];
+        }
+        for (const FrameGraphBufferAccess& access : pass.buffers) {
+            live = live || (bufferUse(access.usage).write && neededBuffers[access.buffer]);
+        }
+        alive[p] = live;
+        if (!live) {
+            continue;
+        }
+
+        for (uint32_t a : pass.colorOutputs) {
+            neededImages[a] = true;
+        }
+        for (uint32_t a : pass.inputs) {
+            neededImages[a] = true;
+        }
+        for (uint32_t a : pass.sampled) {
+            neededImages[a] = true;
+        }
+        if (pass.depthOutput != FRAME_GRAPH_NONE) {
+            neededImages[pass.depthOutput] = true;
+        }
+        for (const FrameGraphBufferAccess& access : pass.buffers) {
+            if (access.usage != FRAME_GRAPH_TRANSFER_WRITE) {
+                neededBuffers[access.buffer] = true;
+            }
+        }
+    }
+}
+
+// Consecutive graphics passes share a render pass unless one samples an
+// image written earlier in it; every other pass is a step of its own
+void FrameGraph::buildSteps() {
+    steps.clear();
+    for (uint32_t p = 0; p < passes.size(); p++) {
+        if (!alive[p]) {
+            continue;
+        }
+        const FrameGraphPass& pass = passes[p];
+        bool merge = isGraphics(pass) && !steps.empty() && steps.back().renderPass;
+        for (size_t i = 0; merge && i < steps.back().passes.size(); i++) {
+            const FrameGraphPass& earlier = passes[steps.back().passes[i]];
+            for (uint32_t a : pass.sampled) {
+                merge = merge && !writes(earlier, a) && !reads(earlier, a);
+            }
+        }
+        if (!merge) {
+            steps.emplace_back();
+            steps.back().renderPass = isGraphics(pass);
+        }
+        steps.back().passes.push_back(p);
+    }
+
+    firstStep.assign(attachments.size(), FRAME_GRAPH_NONE);
+    lastStep.assign(attachments.size(), FRAME_GRAPH_NONE);
+    for (int32_t s = 0; s < static_cast<int32_t>(steps.size()); s++) {
+        for (uint32_t p : steps[s].passes) {
+            const FrameGraphPass& pass = passes[p];
+            for (uint32_t a = 0; a < attachments.size(); a++) {
+                bool sampled = std::find(pass.sampled.begin(), pass.sampled.end(), a) != pass.sampled.end();
+                if (writes(pass, a) || reads(pass, a) || sampled) {
+                    if (firstStep[a] == FRAME_GRAPH_NONE) {
+                        firstStep[a] = s;
+                    }
+                    lastStep[a] = s;
+                }
+            }
+        }
+    }
+}
+
+bool FrameGraph::isTransient(uint32_t attachment) const {
+    if (attachments[attachment].external || firstStep[attachment] != lastStep[attachment] ||
+        firstStep[attachment] == FRAME_GRAPH_NONE) {
+        return false;
+    }
+    for (uint32_t p : steps[firstStep[attachment]].passes) {
+        const std::vector<uint32_t>& sampled = passes[p].sampled;
+        if (std::find(sampled.begin(), sampled.end(), attachment) != sampled.end()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Derives the barrier in front of every step from the access state the
+// previous steps left behind, and the render passes that depend on it
+void FrameGraph::buildBarriers() {
+    std::vector<AccessState> imageStates(attachments.size());
+    std::vector<AccessState> bufferStates(externalBuffers.size());
+
+    for (size_t s = 0; s < steps.size(); s++) {
+        Step& step = steps[s];
+        step.srcStages = 0;
+        step.dstStages = 0;
+        step.srcAccess = 0;
+        step.dstAccess = 0;
+        step.imageBarriers.clear();
+        step.imageBarrierAttachments.clear();
+
+        auto record = [](AccessState& state, VkPipelineStageFlags stages, VkAccessFlags access, bool write) {
+            if (write) {
+                state.writeStages = stages;
+                state.writeAccess = access;
+                state.readStages = 0;
+                state.visibleStages = 0;
+            } else {
+                state.readStages |= stages;
+                state.visibleStages |= stages;
+            }
+            state.touched = true;
+        };
+
+        auto hazard = [&](AccessState& state, VkPipelineStageFlags stages, VkAccessFlags access, bool write) {
+            VkPipelineStageFlags src = 0;
+            VkAccessFlags srcAccess = 0;
+            if (write) {
+                src = state.writeStages | state.readStages;
+                srcAccess = state.writeAccess;
+            } else if (state.writeStages != 0 && (state.visibleStages & stages) != stages) {
+                src = state.writeStages;
+                srcAccess = state.writeAccess;
+            }
+            if (src != 0) {
+                step.srcStages |= src;
+                step.srcAccess |= srcAccess;
+                step.dstStages |= stages;
+                step.dstAccess |= access;
+            }
+            record(state, stages, access, write);
+        };
+
+        auto transition = [&](uint32_t a, AccessState& state, VkPipelineStageFlags stages, VkAccessFlags access,
+                              VkImageLayout layout, bool write) {
+            if (!state.touched && aliasPredecessor[a] != FRAME_GRAPH_NONE) {
+                // Memory reused from an image that is dead by now
+                const AccessState& previous = imageStates[aliasPredecessor[a]];
+                if (previous.touched) {
+                    step.srcStages |= previous.writeStages | previous.readStages;
+                    step.srcAccess |= previous.writeAccess;
+                    step.dstStages |= stages;
+                    step.dstAccess |= access;
+                }
+            }
+            if (state.touched && state.layout != layout) {
+                VkImageMemoryBarrier barrier{};
+                barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                barrier.srcAccessMask = state.writeAccess;
+                barrier.dstAccessMask = access;
+                barrier.oldLayout = state.layout;
+                barrier.newLayout = layout;
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.subresourceRange.aspectMask = attachments[a].depth ? VK_IMAGE_ASPECT_DEPTH_BIT
+                                                                           : VK_IMAGE_ASPECT_COLOR_BIT;
+                barrier.subresourceRange.levelCount = 1;
+                barrier.subresourceRange.layerCount = 1;
+                step.imageBarriers.push_back(barrier);
+                step.imageBarrierAttachments.push_back(a);
+                step.srcStages |= state.writeStages | state.readStages;
+                step.dstStages |= stages;
+                record(state, stages, access, write);
+                state.layout = layout;
+                return;
+            }
+            hazard(state, stages, access, write);
+            state.layout = layout;
+        };
+
+        std::vector<bool> writtenBefore(attachments.size());
+        std::vector<VkImageLayout> layouts(attachments.size());
+        for (uint32_t a = 0; a < attachments.size(); a++) {
+            writtenBefore[a] = imageStates[a].touched;
+            layouts[a] = imageStates[a].layout;
+        }
+
+        for (uint32_t p : step.passes) {
+            const FrameGraphPass& pass = passes[p];
+            VkPipelineStageFlags sampleStage = step.renderPass ? VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
+                                                               : VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+            for (uint32_t a : pass.sampled) {
+                transition(a, imageStates[a], sampleStage, VK_ACCESS_SHADER_READ_BIT,
+                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false);
+            }
+            for (const FrameGraphBufferAccess& access : pass.buffers) {
+                BufferUse use = bufferUse(access.usage);
+                hazard(bufferStates[access.buffer], use.stages, use.access, use.write);
+            }
+        }
+
+        if (!step.renderPass) {
+            continue;
+        }
+
+        // Attachments already used this frame are brought into the layout
+        // of their first subpass here; first uses are left to the render
+        // pass's own external dependency
+        std::vector<bool> seen(attachments.size());
+        for (uint32_t p : step.passes) {
+            const FrameGraphPass& pass = passes[p];
+            for (uint32_t a = 0; a < attachments.size(); a++) {
+                bool read = reads(pass, a);
+                bool written = writes(pass, a);
+                if ((!read && !written) || seen[a]) {
+                    continue;
+                }
+                seen[a] = true;
+                const FrameGraphAttachment& attachment = attachments[a];
+                VkImageLayout layout;
+                VkPipelineStageFlags stages;
+                VkAccessFlags access;
+                if (read && written) {
+                    layout = VK_IMAGE_LAYOUT_GENERAL;
+                    stages = writeStages(attachment) | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+                    access = outputAccess(attachment) | VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+                } else if (written) {
+                    layout = attachment.depth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+                                              : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+                    stages = writeStages(attachment);
+                    access = outputAccess(attachment);
+                } else {
+                    layout = attachment.depth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
+                                              : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                    stages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+                    access = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+                }
+                if (imageStates[a].touched || aliasPredecessor[a] != FRAME_GRAPH_NONE) {
+                    transition(a, imageStates[a], stages, access, layout, written);
+                    layouts[a] = layout;
+                }
+            }
+        }
+
+        step.info = compileRenderPass(s, layouts, writtenBefore);
+
+        // The render pass leaves each attachment in its final layout
+        for (size_t local = 0; local < step.info.graphAttachments.size(); local++) {
+            uint32_t a = step.info.graphAttachments[local];
+            AccessState& state = imageStates[a];
+            bool written = false;
+            bool read = false;
+            for (uint32_t p : step.passes) {
+                written = written || writes(passes[p], a);
+                read = read || reads(passes[p], a);
+            }
+            if (written) {
+                state.writeStages = writeStages(attachments[a]);
+                state.writeAccess = writeAccess(attachments[a]);
+                state.visibleStages = 0;
+            }
+            state.readStages = 0;
+            if (read) {
+                state.readStages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+            }
+            state.layout = step.info.attachments[local].finalLayout;
+            state.touched = true;
+        }
+    }
+}
+
+FrameGraphRenderPass FrameGraph::compileRenderPass(size_t stepIndex, const std::vector<VkImageLayout>& layouts,
+                                                   const std::vector<bool>& writtenBefore) const {
+    const Step& step = steps[stepIndex];
+    FrameGraphRenderPass out;
+    size_t subpassTotal = step.passes.size();
+    out.colorRefs.resize(subpassTotal);
+    out.inputRefs.resize(subpassTotal);
+    out.depthRefs.resize(subpassTotal);
+    out.preserved.resize(subpassTotal);
+
+    // Framebuffer attachments are the referenced graph attachments in id order
+    std::vector<uint32_t> local(attachments.size(), VK_ATTACHMENT_UNUSED);
+    for (uint32_t a = 0; a < attachments.size(); a++) {
+        for (uint32_t p : step.passes) {
+            if ((writes(passes[p], a) || reads(passes[p], a)) && local[a] == VK_ATTACHMENT_UNUSED) {
+                local[a] = static_cast<uint32_t>(out.graphAttachments.size());
+                out.graphAttachments.push_back(a);
+            }
+        }
+    }
+    size_t localTotal = out.graphAttachments.size();
+
+    std::vector<VkImageLayout> lastLayout(localTotal, VK_IMAGE_LAYOUT_UNDEFINED);
+    std::vector<VkAttachmentLoadOp> loadOps(localTotal, VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+    std::vector<int32_t> firstUse(localTotal, FRAME_GRAPH_NONE);
+    std::vector<int32_t> lastUse(localTotal, FRAME_GRAPH_NONE);
+    std::vector<int32_t> lastWriter(localTotal, FRAME_GRAPH_NONE);
+    std::vector<std::vector<uint32_t>> readersSinceWrite(localTotal);
+
+    for (uint32_t sp = 0; sp < subpassTotal; sp++) {
+        const FrameGraphPass& pass = passes[step.passes[sp]];
+
+        // A pass that reads and writes the same attachment needs GENERAL
+        for (uint32_t a : pass.colorOutputs) {
+            VkImageLayout layout = reads(pass, a) ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            out.colorRefs[sp].push_back({local[a], layout});
+            lastLayout[local[a]] = layout;
+        }
+        if (pass.depthOutput != FRAME_GRAPH_NONE) {
+            uint32_t a = static_cast<uint32_t>(pass.depthOutput);
+            VkImageLayout layout = reads(pass, a) ? VK_IMAGE_LAYOUT_GENERAL
+                                                  : VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+            out.depthRefs[sp] = {local[a], layout};
+            lastLayout[local[a]] = layout;
+        } else {
+            out.depthRefs[sp] = {VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED};
+        }
+        for (uint32_t a : pass.inputs) {
+            VkImageLayout layout = VK_IMAGE_LAYOUT_GENERAL;
+            if (!writes(pass, a)) {
+                layout = attachments[a].depth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
+                                              : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            }
+            out.inputRefs[sp].push_back({local[a], layout});
+            lastLayout[local[a]] = layout;
+        }
+
+        for (uint32_t i = 0; i < localTotal; i++) {
+            uint32_t a = out.graphAttachments[i];
+            bool read = reads(pass, a);
+            bool written = writes(pass, a);
+            if (!read && !written) {
+                continue;
+            }
+            const FrameGraphAttachment& attachment = attachments[a];
+
+            if (firstUse[i] == FRAME_GRAPH_NONE) {
+                firstUse[i] = static_cast<int32_t>(sp);
+                if (read || writtenBefore[a]) {
+                    loadOps[i] = VK_ATTACHMENT_LOAD_OP_LOAD;
+                } else if (attachment.clear) {
+                    loadOps[i] = VK_ATTACHMENT_LOAD_OP_CLEAR;
+                }
+                // The first use this frame waits for whatever touched the
+                // image before: the presentation engine, or the previous
+                // frame's writes (of any attachment, if the memory is shared)
+                if (!writtenBefore[a]) {
+                    bool aliased = aliasPredecessor[a] != FRAME_GRAPH_NONE;
+                    VkPipelineStageFlags srcStages = aliased ? ATTACHMENT_WRITE_STAGES : writeStages(attachment);
+                    VkAccessFlags srcAccess = aliased ? ATTACHMENT_WRITE_ACCESS
+                                                      : (attachment.depth ? writeAccess(attachment) : 0);
+                    addDependency(out.dependencies, VK_SUBPASS_EXTERNAL, sp, srcStages, srcAccess,
+                                  writeStages(attachment), writeAccess(attachment));
+                }
+            }
+            lastUse[i] = static_cast<int32_t>(sp);
+
+            // Read after write and write after write
+            if (lastWriter[i] != FRAME_GRAPH_NONE && static_cast<uint32_t>(lastWriter[i]) != sp) {
+                addDependency(out.dependencies, static_cast<uint32_t>(lastWriter[i]), sp,
+                              writeStages(attachment), writeAccess(attachment),
+                              read ? VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT : writeStages(attachment),
+                              read ? VK_ACCESS_INPUT_ATTACHMENT_READ_BIT : writeAccess(attachment));
+            }
+            // Write after read only needs the reads to have executed
+            if (written) {
+                for (uint32_t reader : readersSinceWrite[i]) {
+                    if (reader != sp) {
+                        addDependency(out.dependencies, reader, sp, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                                      writeStages(attachment), 0);
+                    }
+                }
+                readersSinceWrite[i].clear();
+                lastWriter[i] = static_cast<int32_t>(sp);
+            } else {
+                readersSinceWrite[i].push_back(sp);
+            }
+        }
+    }
+
+    // Subpasses between an attachment's first and last use must keep it
+    for (uint32_t i = 0; i < localTotal; i++) {
+        uint32_t a = out.graphAttachments[i];
+        for (int32_t sp = firstUse[i] + 1; sp < lastUse[i]; sp++) {
+            if (!reads(passes[step.passes[sp]], a) && !writes(passes[step.passes[sp]], a)) {
+                out.preserved[sp].push_back(i);
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < localTotal; i++) {
+        uint32_t a = out.graphAttachments[i];
+        const FrameGraphAttachment& attachment = attachments[a];
+        bool usedLater = lastStep[a] > static_cast<int32_t>(stepIndex);
+
+        VkAttachmentDescription description{};
+        description.format = attachment.format;
+        description.samples = VK_SAMPLE_COUNT_1_BIT;
+        description.loadOp = loadOps[i];
+        description.storeOp = attachment.external || usedLater ? VK_ATTACHMENT_STORE_OP_STORE
+                                                               : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        if (writtenBefore[a]) {
+            description.initialLayout = layouts[a];
+        } else if (loadOps[i] == VK_ATTACHMENT_LOAD_OP_LOAD && attachment.external) {
+            description.initialLayout = attachment.finalLayout;
+        } else {
+            description.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        }
+        description.finalLayout = attachment.external && !usedLater ? attachment.finalLayout : lastLayout[i];
+        out.attachments.push_back(description);
+        out.clearValues.push_back(attachment.clearValue);
+    }
+
+    // References are final now, so the descriptions can point into them
+    for (uint32_t sp = 0; sp < subpassTotal; sp++) {
+        VkSubpassDescription subpass{};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = static_cast<uint32_t>(out.colorRefs[sp].size());
+        subpass.pColorAttachments = out.colorRefs[sp].data();
+        subpass.inputAttachmentCount = static_cast<uint32_t>(out.inputRefs[sp].size());
+        subpass.pInputAttachments = out.inputRefs[sp].data();
+        if (out.depthRefs[sp].attachment != VK_ATTACHMENT_UNUSED) {
+            subpass.pDepthStencilAttachment = &out.depthRefs[sp];
+        }
+        subpass.preserveAttachmentCount = static_cast<uint32_t>(out.preserved[sp].size());
+        subpass.pPreserveAttachments = out.preserved[sp].data();
+        out.subpasses.push_back(subpass);
+    }
+    return out;
+}
+
+// Largest first, each image goes to the lowest offset that does not overlap
+// an already placed image alive during any of the same steps
+VkDeviceSize FrameGraph::planAliasing(const std::vector<uint32_t>& aliasImages,
+                                      const std::vector<VkMemoryRequirements>& requirements,
+                                      std::vector<VkDeviceSize>& offsets) {
+    size_t count = aliasImages.size();
+    offsets.assign(count, 0);
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::sort(order.begin(), order.end(),
+              [&](size_t x, size_t y) { return requirements[x].size > requirements[y].size; });
+
+    auto lifetimesOverlap = [&](size_t x, size_t y) {
+        uint32_t a = aliasImages[x];
+        uint32_t b = aliasImages[y];
+        if (firstStep[a] == FRAME_GRAPH_NONE || firstStep[b] == FRAME_GRAPH_NONE) {
+            return false;
+        }
+        return firstStep[a] <= lastStep[b] && firstStep[b] <= lastStep[a];
+    };
+    auto memoryOverlaps = [&](size_t x, VkDeviceSize offset, size_t y) {
+        return offset < offsets[y] + requirements[y].size && offsets[y] < offset + requirements[x].size;
+    };
+
+    std::vector<size_t> placed;
+    VkDeviceSize total = 0;
+    for (size_t x : order) {
+        VkDeviceSize alignment = std::max<VkDeviceSize>(requirements[x].alignment, 1);
+        std::vector<VkDeviceSize> candidates = {0};
+        for (size_t y : placed) {
+            if (lifetimesOverlap(x, y)) {
+                VkDeviceSize end = offsets[y] + requirements[y].size;
+                candidates.push_back((end + alignment - 1) / alignment * alignment);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+        for (VkDeviceSize offset : candidates) {
+            bool fits = true;
+            for (size_t y : placed) {
+                fits = fits && !(lifetimesOverlap(x, y) && memoryOverlaps(x, offset, y));
+            }
+            if (fits) {
+                offsets[x] = offset;
+                break;
+            }
+        }
+        placed.push_back(x);
+        total = std::max(total, offsets[x] + requirements[x].size);
+    }
+
+    // Each image's first use waits for the last earlier user of its memory
+    for (size_t x = 0; x < count; x++) {
+        uint32_t a = aliasImages[x];
+        aliasPredecessor[a] = FRAME_GRAPH_NONE;
+        for (size_t y = 0; y < count; y++) {
+            uint32_t b = aliasImages[y];
+            if (x == y || firstStep[a] == FRAME_GRAPH_NONE || lastStep[b] == FRAME_GRAPH_NONE ||
+                lastStep[b] >= firstStep[a] || !memoryOverlaps(x, offsets[x], y)) {
+                continue;
+            }
+            if (aliasPredecessor[a] == FRAME_GRAPH_NONE || lastStep[aliasPredecessor[a]] < lastStep[b]) {
+                aliasPredecessor[a] = static_cast<int32_t>(b);
+            }
+        }
+    }
+    buildBarriers();
+    return total;
+}
+
+void FrameGraph::createRenderPasses(VkDevice device) {
+    for (Step& step : steps) {
+        if (!step.renderPass) {
+            continue;
+        }
+        VkRenderPassCreateInfo renderPassInfo = step.info.createInfo();
+        if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &step.handle) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create render pass!");
+        }
+    }
+}
+
+void FrameGraph::destroyRenderPasses(VkDevice device) {
+    for (Step& step : steps) {
+        if (step.handle != VK_NULL_HANDLE) {
+            vkDestroyRenderPass(device, step.handle, nullptr);
+            step.handle = VK_NULL_HANDLE;
+        }
+    }
+}
+
+VkRenderPass FrameGraph::renderPass(uint32_t pass) const {
+    int32_t s = stepOf(pass);
+    return s == FRAME_GRAPH_NONE ? VK_NULL_HANDLE : steps[s].handle;
+}
+
+const std::vector<uint32_t>& FrameGraph::framebufferAttachments(uint32_t pass) const {
+    return steps[stepOf(pass)].info.graphAttachments;
+}
+
+const FrameGraphRenderPass& FrameGraph::renderPassInfo(uint32_t pass) const {
+    return steps[stepOf(pass)].info;
+}
+
+void FrameGraph::setFramebuffer(uint32_t pass, VkFramebuffer framebuffer, VkExtent2D extent) {
+    int32_t s = stepOf(pass);
+    if (s != FRAME_GRAPH_NONE) {
+        steps[s].framebuffer = framebuffer;
+        steps[s].extent = extent;
+    }
+}
+
+void FrameGraph::execute(VkCommandBuffer commandBuffer, std::pmr::memory_resource* scratch) const {
+    std::pmr::vector<VkImageMemoryBarrier> imageBarriers(scratch);
+    for (const Step& step : steps) {
+        if (step.srcStages != 0) {
+            imageBarriers.assign(step.imageBarriers.begin(), step.imageBarriers.end());
+            for (size_t i = 0; i < imageBarriers.size(); i++) {
+                imageBarriers[i].image = images[step.imageBarrierAttachments[i]];
+            }
+            VkMemoryBarrier memoryBarrier{};
+            memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            memoryBarrier.srcAccessMask = step.srcAccess;
+            memoryBarrier.dstAccessMask = step.dstAccess;
+            uint32_t memoryBarrierCount = step.srcAccess != 0 || step.dstAccess != 0 ? 1 : 0;
+            vkCmdPipelineBarrier(commandBuffer, step.srcStages, step.dstStages, 0,
+                                 memoryBarrierCount, &memoryBarrier, 0, nullptr,
+                                 static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+        }
+
+        if (!step.renderPass) {
+            for (uint32_t p : step.passes) {
+                if (passes[p].record) {
+                    passes[p].record(commandBuffer);
+                }
+            }
+            continue;
+        }
+
+        VkRenderPassBeginInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassInfo.renderPass = step.handle;
+        renderPassInfo.framebuffer = step.framebuffer;
+        renderPassInfo.renderArea.offset = {0, 0};
+        renderPassInfo.renderArea.extent = step.extent;
+        renderPassInfo.clearValueCount = static_cast<uint32_t>(step.info.clearValues.size());
+        renderPassInfo.pClearValues = step.info.clearValues.data();
+
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        for (size_t i = 0; i < step.passes.size(); i++) {
+            if (i > 0) {
+                vkCmdNextSubpass(commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+            }
+            const FrameGraphPass& pass = passes[step.passes[i]];
+            if (pass.record) {
+                pass.record(commandBuffer);
+            }
+        }
+        vkCmdEndRenderPass(commandBuffer);
+    }
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <vector>
+
+// Frame graph: the frame is described as passes that declare which
+// attachments and buffers they write and read, and everything that follows
+// from that is derived instead of written by hand:
+//
+// - passes whose results nothing consumes are culled
+// - consecutive graphics passes are merged into subpasses of one render
+//   pass, so intermediate attachments (e.g. a scene colour read by a
+//   post-processing or HUD pass through an input attachment) stay in tile
+//   memory; a pass that samples an image written in the same render pass,
+//   or a compute/transfer pass, splits it
+// - load and store ops: an attachment's first write in the frame clears it
+//   or, if it overwrites every pixel, does not care about the old contents;
+//   it is loaded only when earlier work left contents behind, and stored
+//   only when it is external (the swapchain) or read after its render pass
+// - pipeline barriers between steps carry exactly the stages and accesses
+//   of the hazards between them, and image layout transitions
+// - images whose lifetimes do not overlap can share memory (planAliasing)
+
+const int32_t FRAME_GRAPH_NONE = -1;
+
+struct FrameGraphAttachment {
+    VkFormat format;
+    bool depth;
+    bool clear;                  // First write clears; otherwise it covers every pixel
+    bool external;               // Outlives the frame: stored, and left in finalLayout
+    VkImageLayout finalLayout;   // Only used for external attachments
+    VkClearValue clearValue = {};
+};
+
+enum FrameGraphBufferUsage : uint8_t {
+    FRAME_GRAPH_TRANSFER_WRITE,
+    FRAME_GRAPH_COMPUTE_READ,
+    FRAME_GRAPH_COMPUTE_WRITE,          // Read-write storage in a compute shader
+    FRAME_GRAPH_INDIRECT_READ,
+    FRAME_GRAPH_VERTEX_SHADER_READ,
+};
+
+struct FrameGraphBufferAccess {
+    uint32_t buffer;
+    FrameGraphBufferUsage usage;
+};
+
+// A pass with colour, depth or input attachments is a graphics pass and runs
+// inside a render pass; anything else runs outside one. record is called at
+// execute() time with the pass's subpass (if any) already active.
+struct FrameGraphPass {
+    const char* name = "";
+    std::vector<uint32_t> colorOutputs;
+    std::vector<uint32_t> inputs;              // Read as input attachments, same pixel only
+    int32_t depthOutput = FRAME_GRAPH_NONE;
+    std::vector<uint32_t> sampled;             // Attachments sampled by fragment shaders
+    std::vector<FrameGraphBufferAccess> buffers;
+    std::function<void(VkCommandBuffer)> record;
+    bool sideEffects = false;                  // Never culled
+};
+
+// Everything vkCreateRenderPass needs. The subpass descriptions point into
+// the reference vectors, so the object is move-only.
+struct FrameGraphRenderPass {
+    std::vector<uint32_t> graphAttachments;                      // Framebuffer order: graph attachment ids
+    std::vector<VkAttachmentDescription> attachments;
+    std::vector<VkClearValue> clearValues;
+    std::vector<VkSubpassDescription> subpasses;
+    std::vector<VkSubpassDependency> dependencies;
+
+    std::vector<std::vector<VkAttachmentReference>> colorRefs;   // [subpass]
+    std::vector<std::vector<VkAttachmentReference>> inputRefs;   // [subpass]
+    std::vector<VkAttachmentReference> depthRefs;                // [subpass]
+    std::vector<std::vector<uint32_t>> preserved;                // [subpass]
+
+    FrameGraphRenderPass() = default;
+    FrameGraphRenderPass(const FrameGraphRenderPass&) = delete;
+    FrameGraphRenderPass& operator=(const FrameGraphRenderPass&) = delete;
+    FrameGraphRenderPass(FrameGraphRenderPass&&) = default;
+    FrameGraphRenderPass& operator=(FrameGraphRenderPass&&) = default;
+
+    VkRenderPassCreateInfo createInfo() const;
+};
+
+class FrameGraph {
+public:
+    uint32_t addAttachment(const FrameGraphAttachment& attachment);
+    uint32_t addBuffer(bool external);           // External buffers are read after the frame
+    uint32_t addPass(FrameGraphPass pass);
+
+    const FrameGraphAttachment& attachment(uint32_t index) const { return attachments[index]; }
+    size_t attachmentCount() const { return attachments.size(); }
+    size_t passCount() const { return passes.size(); }
+
+    // Culls passes, groups the rest into steps and derives render passes and
+    // barriers. Call after the last addPass and before anything below.
+    void compile();
+
+    bool isCulled(uint32_t pass) const { return !alive[pass]; }
+
+    // Only ever lives inside one render pass, never loaded or stored, so its
+    // image can use TRANSIENT_ATTACHMENT usage and lazily allocated memory
+    bool isTransient(uint32_t attachment) const;
+
+    // Places the given images in one allocation so images that are never
+    // alive at the same time share memory. Fills offsets and returns the
+    // allocation size; the barriers are updated to order the reuse.
+    VkDeviceSize planAliasing(const std::vector<uint32_t>& images,
+                              const std::vector<VkMemoryRequirements>& requirements,
+                              std::vector<VkDeviceSize>& offsets);
+
+    void createRenderPasses(VkDevice device);
+    void destroyRenderPasses(VkDevice device);
+
+    // Render pass and framebuffer attachment order of the step running a pass
+    VkRenderPass renderPass(uint32_t pass) const;
+    const std::vector<uint32_t>& framebufferAttachments(uint32_t pass) const;
+    const FrameGraphRenderPass& renderPassInfo(uint32_t pass) const;
+
+    // Per-frame bindings used by execute()
+    void setFramebuffer(uint32_t pass, VkFramebuffer framebuffer, VkExtent2D extent);
+    void bindImage(uint32_t attachment, VkImage image) { images[attachment] = image; }
+
+    // scratch holds the frame's barrier arrays; pass a frame arena to keep
+    // recording off the heap
+    void execute(VkCommandBuffer commandBuffer,
+                 std::pmr::memory_resource* scratch = std::pmr::get_default_resource()) const;
+
+private:
+    struct Step {
+        bool renderPass = false;
+        std::vector<uint32_t> passes;
+        FrameGraphRenderPass info;
+        VkRenderPass handle = VK_NULL_HANDLE;
+        VkFramebuffer framebuffer = VK_NULL_HANDLE;
+        VkExtent2D extent = {0, 0};
+
+        // Barrier recorded before the step
+        VkPipelineStageFlags srcStages = 0;
+        VkPipelineStageFlags dstStages = 0;
+        VkAccessFlags srcAccess = 0;
+        VkAccessFlags dstAccess = 0;
+        std::vector<VkImageMemoryBarrier> imageBarriers;
+        std::vector<uint32_t> imageBarrierAttachments;
+    };
+
+    bool writes(const FrameGraphPass& pass, uint32_t attachment) const;
+    bool reads(const FrameGraphPass& pass, uint32_t attachment) const;
+    bool isGraphics(const FrameGraphPass& pass) const;
+    int32_t stepOf(uint32_t pass) const;
+
+    void cullPasses();
+    void buildSteps();
+    void buildBarriers();
+    FrameGraphRenderPass compileRenderPass(size_t step, const std::vector<VkImageLayout>& layouts,
+                                           const std::vector<bool>& written) const;
+
+    std::vector<FrameGraphAttachment> attachments;
+    std::vector<bool> externalBuffers;
+    std::vector<FrameGraphPass> passes;
+    std::vector<VkImage> images;
+
+    std::vector<bool> alive;                     // [pass]
+    std::vector<Step> steps;
+    std::vector<int32_t> firstStep, lastStep;    // [attachment] lifetime in steps
+    std::vector<int32_t> aliasPredecessor;       // [attachment] previous user of its memory
+};
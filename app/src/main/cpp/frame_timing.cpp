@@ -0,0 +1,33 @@
+#include "frame_timing.h"
+
+#include <algorithm>
+#include <iomanip>
+
+std::chrono::nanoseconds FrameTimeSeries::percentile(double p) const {
+    if (samples.empty()) {
+        return std::chrono::nanoseconds(0);
+    }
+    std::vector<std::chrono::nanoseconds> sorted = samples;
+    size_t rank = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1));
+    std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(rank), sorted.end());
+    return sorted[rank];
+}
+
+std::chrono::nanoseconds FrameTimeSeries::mean() const {
+    if (samples.empty()) {
+        return std::chrono::nanoseconds(0);
+    }
+    std::chrono::nanoseconds total(0);
+    for (std::chrono::nanoseconds sample : samples) {
+        total += sample;
+    }
+    return total / static_cast<int64_t>(samples.size());
+}
+
+void FrameTimeSeries::print(std::ostream& out, const char* name) const {
+    auto us = [](std::chrono::nanoseconds ns) { return ns.count() / 1000.0; };
+    out << std::fixed << std::setprecision(1);
+    out << name << ": " << samples.size() << " frames, mean " << us(mean()) << " us, p50 " << us(percentile(0.5))
+        << " us, p90 " << us(percentile(0.9)) << " us, p99 " << us(percentile(0.99)) << " us, max "
+        << us(percentile(1.0)) << " us\n";
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+// Per-frame durations of one stage of the frame, kept whole so percentiles
+// are exact at any resolution. Reserve the frame count up front and adding
+// never allocates.
+class FrameTimeSeries {
+public:
+    void reserve(size_t frames) { samples.reserve(frames); }
+    void add(std::chrono::nanoseconds time) { samples.push_back(time); }
+
+    size_t count() const { return samples.size(); }
+    std::chrono::nanoseconds percentile(double p) const;   // Nearest rank, p in [0, 1]
+    std::chrono::nanoseconds mean() const;
+
+    void print(std::ostream& out, const char* name) const;
+
+private:
+    std::vector<std::chrono::nanoseconds> samples;
+};
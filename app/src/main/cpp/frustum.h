@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cmath>
+
+struct Plane { float a, b, c, d; };
+
+// View frustum as six inward-facing planes, extracted from a column-major
+// projection * view matrix with Vulkan clip space (0 <= z <= w).
+struct Frustum {
+    Plane planes[6];
+
+    static Frustum fromViewProjection(const float* m) {
+        // Row r of the matrix is (m[r], m[4+r], m[8+r], m[12+r]); planes are w +/- row
+        auto combine = [m](int r, float sign) -> Plane {
+            return {
+                m[3] + sign * m[r],
+                m[7] + sign * m[4 + r],
+                m[11] + sign * m[8 + r],
+                m[15] + sign * m[12 + r]
+            };
+        };
+
+        Frustum f;
+        f.planes[0] = combine(0, 1.0f);    // Left
+        f.planes[1] = combine(0, -1.0f);   // Right
+        f.planes[2] = combine(1, 1.0f);    // Bottom
+        f.planes[3] = combine(1, -1.0f);   // Top
+        f.planes[4] = {m[2], m[6], m[10], m[14]};  // Near (z >= 0)
+        f.planes[5] = combine(2, -1.0f);   // Far
+
+        for (Plane& p : f.planes) {
+            float length = std::sqrt(p.a*p.a + p.b*p.b + p.c*p.c);
+            if (length > 0.0f) {
+                p.a /= length;
+                p.b /= length;
+                p.c /= length;
+                p.d /= length;
+            }
+        }
+        return f;
+    }
+
+    bool containsSphere(float x, float y, float z, float radius) const {
+        for (const Plane& p : planes) {
+            if (p.a*x + p.b*y + p.c*z + p.d < -radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+// Logging for the GLES game: logcat on Android, stdout/stderr on the
+// desktop harness
+#ifdef __ANDROID__
+#include <android/log.h>
+
+#define LOG_TAG "NDKGame"
+#define LOGI(...) ((void)__android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__))
+#define LOGE(...) ((void)__android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__))
+#else
+#include <cstdio>
+
+#define LOGI(...) ((void)fprintf(stdout, __VA_ARGS__), (void)fputc('\n', stdout))
+#define LOGE(...) ((void)fprintf(stderr, __VA_ARGS__), (void)fputc('\n', stderr))
+#endif
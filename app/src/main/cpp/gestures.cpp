@@ -0,0 +1,172 @@
+#include "gestures.h"
+
+#include <cmath>
+
+void GestureRecognizer::pointerDown(int32_t id, float x, float y, TimePoint time) {
+    Pointer* slot = nullptr;
+    for (Pointer& pointer : pointers) {
+        if (pointer.id < 0) {
+            slot = &pointer;
+            break;
+        }
+    }
+    if (!slot || find(id)) {
+        return;   // More fingers than gestures use
+    }
+    slot->id = id;
+    slot->historyCount = 0;
+    record(*slot, x, y, time);
+    pointerCount++;
+
+    switch (state) {
+    case STATE_IDLE:
+        state = STATE_PRESS;
+        startX = x;
+        startY = y;
+        startTime = time;
+        break;
+    case STATE_DRAG:
+        push({GESTURE_DRAG_END, pointers[0].x, pointers[0].y, 0.0f, 0.0f, 1.0f, time});
+        [[fallthrough]];
+    case STATE_PRESS: {
+        state = STATE_PINCH;
+        float centerX, centerY;
+        TimePoint latest;
+        pinchShape(centerX, centerY, pinchSpan, latest);
+        movedSinceFlush = false;
+        break;
+    }
+    case STATE_PINCH:
+    case STATE_FINISHING:
+        break;
+    }
+}
+
+void GestureRecognizer::pointerMove(int32_t id, float x, float y, TimePoint time) {
+    Pointer* pointer = find(id);
+    if (!pointer) {
+        return;
+    }
+    record(*pointer, x, y, time);
+
+    if (state == STATE_PRESS) {
+        float dx = x - startX;
+        float dy = y - startY;
+        if (dx * dx + dy * dy > thresholds.slop * thresholds.slop) {
+            state = STATE_DRAG;
+            push({GESTURE_DRAG_BEGIN, startX, startY, 0.0f, 0.0f, 1.0f, time});
+            movedSinceFlush = true;
+        }
+    } else if (state == STATE_DRAG || state == STATE_PINCH) {
+        movedSinceFlush = true;
+    }
+}
+
+void GestureRecognizer::pointerUp(int32_t id, float x, float y, TimePoint time) {
+    Pointer* pointer = find(id);
+    if (!pointer) {
+        return;
+    }
+    record(*pointer, x, y, time);
+
+    switch (state) {
+    case STATE_PRESS:
+        if (time - startTime <= thresholds.tapTimeout) {
+            push({GESTURE_TAP, startX, startY, 0.0f, 0.0f, 1.0f, time});
+        }
+        break;
+    case STATE_DRAG: {
+        push({GESTURE_DRAG_END, x, y, 0.0f, 0.0f, 1.0f, time});
+        float vx, vy;
+        releaseVelocity(*pointer, vx, vy);
+        if (vx * vx + vy * vy >= thresholds.swipeSpeed * thresholds.swipeSpeed) {
+            push({GESTURE_SWIPE, startX, startY, vx, vy, 1.0f, time});
+        }
+        break;
+    }
+    case STATE_PINCH:
+        if (movedSinceFlush) {
+            // Report the last movement before the pinch is over
+            float centerX, centerY, span;
+            TimePoint latest;
+            pinchShape(centerX, centerY, span, latest);
+            float scale = pinchSpan > 0.0f && span > 0.0f ? span / pinchSpan : 1.0f;
+            push({GESTURE_PINCH, centerX, centerY, 0.0f, 0.0f, scale, latest});
+        }
+        break;
+    case STATE_IDLE:
+    case STATE_FINISHING:
+        break;
+    }
+
+    pointer->id = -1;
+    pointerCount--;
+    movedSinceFlush = false;
+    state = pointerCount == 0 ? STATE_IDLE : STATE_FINISHING;
+}
+
+void GestureRecognizer::cancel(TimePoint time) {
+    if (state == STATE_DRAG) {
+        push({GESTURE_DRAG_END, pointers[0].x, pointers[0].y, 0.0f, 0.0f, 1.0f, time});
+    }
+    for (Pointer& pointer : pointers) {
+        pointer.id = -1;
+    }
+    pointerCount = 0;
+    movedSinceFlush = false;
+    state = STATE_IDLE;
+}
+
+GestureRecognizer::Pointer* GestureRecognizer::find(int32_t id) {
+    for (Pointer& pointer : pointers) {
+        if (pointer.id == id) {
+            return &pointer;
+        }
+    }
+    return nullptr;
+}
+
+void GestureRecognizer::record(Pointer& pointer, float x, float y, TimePoint time) {
+    pointer.x = x;
+    pointer.y = y;
+    pointer.time = time;
+    pointer.history[pointer.historyCount % HISTORY] = {x, y, time};
+    pointer.historyCount++;
+}
+
+void GestureRecognizer::releaseVelocity(const Pointer& pointer, float& vx, float& vy) const {
+    vx = 0.0f;
+    vy = 0.0f;
+    // Oldest sample still inside the window; historical samples are what
+    // make this accurate for a fast flick
+    uint32_t count = pointer.historyCount < HISTORY ? pointer.historyCount : static_cast<uint32_t>(HISTORY);
+    const Sample& newest = pointer.history[(pointer.historyCount - 1) % HISTORY];
+    const Sample* oldest = &newest;
+    for (uint32_t k = 1; k < count; k++) {
+        const Sample& sample = pointer.history[(pointer.historyCount - 1 - k) % HISTORY];
+        if (newest.time - sample.time > thresholds.velocityWindow) {
+            break;
+        }
+        oldest = &sample;
+    }
+    float seconds = std::chrono::duration<float>(newest.time - oldest->time).count();
+    if (seconds > 0.0f) {
+        vx = (newest.x - oldest->x) / seconds;
+        vy = (newest.y - oldest->y) / seconds;
+    }
+}
+
+void GestureRecognizer::pinchShape(float& x, float& y, float& span, TimePoint& time) const {
+    const Pointer& a = pointers[0];
+    const Pointer& b = pointers[1];
+    x = (a.x + b.x) * 0.5f;
+    y = (a.y + b.y) * 0.5f;
+    span = std::sqrt((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y));
+    time = a.time > b.time ? a.time : b.time;
+}
+
+void GestureRecognizer::push(const Gesture& gesture) {
+    if (pendingCount < MAX_PENDING) {
+        pending[pendingCount++] = gesture;
+    }
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+enum GestureType : uint8_t {
+    GESTURE_TAP,          // Short press without movement, at (x, y)
+    GESTURE_DRAG_BEGIN,   // One pointer moved past the slop, at (x, y)
+    GESTURE_DRAG,         // Drag moved to (x, y)
+    GESTURE_DRAG_END,     // Drag released at (x, y)
+    GESTURE_SWIPE,        // Drag released fast: started at (x, y), velocity (vx, vy) per second
+    GESTURE_PINCH         // Two pointers around (x, y); scale relative to the previous pinch
+};
+
+// Recognized gesture in the units the samples were fed in
+struct Gesture {
+    GestureType type;
+    float x, y;
+    float vx, vy;
+    float scale;
+    std::chrono::steady_clock::time_point time;   // Newest sample it covers
+};
+
+// Distances in the units the samples are fed in; the defaults suit the GLES
+// game's 10 x 15 pitch
+struct GestureThresholds {
+    float slop = 0.15f;                              // Movement before a press becomes a drag
+    std::chrono::milliseconds tapTimeout{250};       // Longest press that still counts as a tap
+    float swipeSpeed = 8.0f;                         // Release speed of a swipe, per second
+    std::chrono::milliseconds velocityWindow{80};    // Samples the release velocity is taken over
+};
+
+// Turns raw pointer samples, historical ones included, into a few compact
+// gestures. Feed every sample of a frame's input events, then flush() once
+// per frame: discrete gestures (tap, drag begin/end, swipe) come out as they
+// happened, continuous ones (drag, pinch) at most once per flush, however
+// many samples moved them. Each sample costs O(1) and nothing allocates.
+//
+// One pointer drags, taps or swipes; a second pointer turns it into a
+// pinch, and nothing more is recognized until every pointer is up.
+class GestureRecognizer {
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    GestureRecognizer() = default;
+    explicit GestureRecognizer(const GestureThresholds& thresholds) : thresholds(thresholds) {}
+
+    void pointerDown(int32_t id, float x, float y, TimePoint time);
+    void pointerMove(int32_t id, float x, float y, TimePoint time);
+    void pointerUp(int32_t id, float x, float y, TimePoint time);
+    void cancel(TimePoint time);   // Ends a drag, drops every pointer
+
+    // Calls emit(const Gesture&) for everything recognized since the last
+    // flush, oldest first
+    template <typename Emit>
+    void flush(Emit&& emit) {
+        for (size_t i = 0; i < pendingCount; i++) {
+            emit(pending[i]);
+        }
+        pendingCount = 0;
+        if (movedSinceFlush) {
+            movedSinceFlush = false;
+            if (state == STATE_DRAG) {
+                const Pointer& p = pointers[0];
+                emit(Gesture{GESTURE_DRAG, p.x, p.y, 0.0f, 0.0f, 1.0f, p.time});
+            } else if (state == STATE_PINCH) {
+                float x, y, span;
+                TimePoint time;
+                pinchShape(x, y, span, time);
+                float scale = pinchSpan > 0.0f && span > 0.0f ? span / pinchSpan : 1.0f;
+                pinchSpan = span;
+                emit(Gesture{GESTURE_PINCH, x, y, 0.0f, 0.0f, scale, time});
+            }
+        }
+    }
+
+private:
+    static constexpr size_t MAX_POINTERS = 2;
+    static constexpr size_t HISTORY = 8;   // Recent samples per pointer, for the release velocity
+    static constexpr size_t MAX_PENDING = 16;
+
+    enum State : uint8_t {
+        STATE_IDLE,
+        STATE_PRESS,      // One pointer down, not moved past the slop yet
+        STATE_DRAG,
+        STATE_PINCH,
+        STATE_FINISHING   // A pinch ended; wait for every pointer to lift
+    };
+
+    struct Sample {
+        float x, y;
+        TimePoint time;
+    };
+
+    struct Pointer {
+        int32_t id = -1;   // -1: free slot
+        float x = 0.0f, y = 0.0f;
+        TimePoint time;
+        Sample history[HISTORY] = {};
+        uint32_t historyCount = 0;
+    };
+
+    Pointer* find(int32_t id);
+    void record(Pointer& pointer, float x, float y, TimePoint time);
+    void releaseVelocity(const Pointer& pointer, float& vx, float& vy) const;
+    void pinchShape(float& x, float& y, float& span, TimePoint& time) const;
+    void push(const Gesture& gesture);
+
+    GestureThresholds thresholds;
+    Pointer pointers[MAX_POINTERS];
+    uint32_t pointerCount = 0;
+    State state = STATE_IDLE;
+    float startX = 0.0f, startY = 0.0f;   // Where the first pointer went down
+    TimePoint startTime;
+    float pinchSpan = 0.0f;               // Span at the last pinch emitted
+    bool movedSinceFlush = false;
+
+    Gesture pending[MAX_PENDING];
+    size_t pendingCount = 0;
+};
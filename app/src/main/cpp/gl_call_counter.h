@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+// Debug GL call counting, the GL counterpart of allocation_counter.h. Built
+// with GL_CALL_COUNTING, the renderer's per-frame GL calls go through the
+// macros below, which count them before making them. Without it the counts
+// stay at zero and the calls are untouched. Include after the GL headers.
+#ifndef GL_CALL_COUNTING
+#define GL_CALL_COUNTING 0
+#endif
+
+struct GlCallCounts {
+    uint64_t calls = 0;   // Every counted call, draws included
+    uint64_t draws = 0;
+};
+
+// Render thread only
+inline GlCallCounts glCallCounts;
+
+#if GL_CALL_COUNTING
+#define GL_COUNTED(call) (glCallCounts.calls++, call)
+#define GL_COUNTED_DRAW(call) (glCallCounts.calls++, glCallCounts.draws++, call)
+
+#define glClearColor(...) GL_COUNTED(glClearColor(__VA_ARGS__))
+#define glClear(...) GL_COUNTED(glClear(__VA_ARGS__))
+#define glEnable(...) GL_COUNTED(glEnable(__VA_ARGS__))
+#define glUseProgram(...) GL_COUNTED(glUseProgram(__VA_ARGS__))
+#define glUniformMatrix4fv(...) GL_COUNTED(glUniformMatrix4fv(__VA_ARGS__))
+#define glUniform4f(...) GL_COUNTED(glUniform4f(__VA_ARGS__))
+#define glEnableVertexAttribArray(...) GL_COUNTED(glEnableVertexAttribArray(__VA_ARGS__))
+#define glDisableVertexAttribArray(...) GL_COUNTED(glDisableVertexAttribArray(__VA_ARGS__))
+#define glVertexAttrib4fv(...) GL_COUNTED(glVertexAttrib4fv(__VA_ARGS__))
+#define glVertexAttribPointer(...) GL_COUNTED(glVertexAttribPointer(__VA_ARGS__))
+#define glDrawElements(...) GL_COUNTED_DRAW(glDrawElements(__VA_ARGS__))
+#define glDrawArrays(...) GL_COUNTED_DRAW(glDrawArrays(__VA_ARGS__))
+#endif
@@ -0,0 +1,423 @@
+#include "gles_game.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "game_log.h"
+#include "gl_call_counter.h"
+#include "meshes.h"
+
+// Pitch dimensions in game units
+constexpr float PITCH_WIDTH = 10.0f;
+constexpr float PITCH_HEIGHT = 15.0f;
+constexpr float PITCH_MARGIN = 0.2f;
+constexpr float PITCH_DEPTH = -0.5f;
+constexpr float PITCH_LINE_DEPTH = PITCH_DEPTH + 0.1f;
+constexpr int BALL_SPHERE_SEGMENTS = 16;
+
+constexpr float BALL_KICK_REACH = 1.0f;        // How close to the ball a swipe must start to kick it
+constexpr float BALL_MAX_KICK_SPEED = 0.3f;    // Per simulation step
+constexpr float MIN_ZOOM = 0.75f;
+constexpr float MAX_ZOOM = 3.0f;
+
+// Static meshes, generated at compile time. Players and the ball use unit
+// meshes placed by uOffsetScale and coloured through a constant attribute.
+constexpr auto CUBE_POSITIONS = makeCubePositions();
+constexpr auto CUBE_INDICES = makeCubeIndices<GLushort>();
+constexpr auto SPHERE_POSITIONS = makeSpherePositions<BALL_SPHERE_SEGMENTS, BALL_SPHERE_SEGMENTS>();
+constexpr auto SPHERE_INDICES = makeSphereIndices<GLushort, BALL_SPHERE_SEGMENTS, BALL_SPHERE_SEGMENTS>();
+
+constexpr float PITCH_HALF_W = PITCH_WIDTH / 2.0f;
+constexpr float PITCH_HALF_H = PITCH_HEIGHT / 2.0f;
+constexpr Vertex FIELD_VERTICES[] = {
+    // Field surface (green), drawn as a triangle strip
+    {-PITCH_HALF_W + PITCH_MARGIN, -PITCH_HALF_H + PITCH_MARGIN, PITCH_DEPTH, 0.0f, 0.5f, 0.0f, 1.0f},
+    {PITCH_HALF_W - PITCH_MARGIN, -PITCH_HALF_H + PITCH_MARGIN, PITCH_DEPTH, 0.0f, 0.5f, 0.0f, 1.0f},
+    {-PITCH_HALF_W + PITCH_MARGIN, PITCH_HALF_H - PITCH_MARGIN, PITCH_DEPTH, 0.0f, 0.5f, 0.0f, 1.0f},
+    {PITCH_HALF_W - PITCH_MARGIN, PITCH_HALF_H - PITCH_MARGIN, PITCH_DEPTH, 0.0f, 0.5f, 0.0f, 1.0f},
+    // Field boundaries (white): top, bottom, left, right
+    {-PITCH_HALF_W, PITCH_HALF_H, PITCH_LINE_DEPTH, 1.0f, 1.0f, 1.0f, 1.0f},
+    {PITCH_HALF_W, PITCH_HALF_H, PITCH_LINE_DEPTH, 1.0f, 1.0f, 1.0f, 1.0f},
+    {-PITCH_HALF_W, -PITCH_HALF_H, PITCH_LINE_DEPTH, 1.0f, 1.0f, 1.0f, 1.0f},
+    {PITCH_HALF_W, -PITCH_HALF_H, PITCH_LINE_DEPTH, 1.0f, 1.0f, 1.0f, 1.0f},
+    {-PITCH_HALF_W, -PITCH_HALF_H, PITCH_LINE_DEPTH, 1.0f, 1.0f, 1.0f, 1.0f},
+    {-PITCH_HALF_W, PITCH_HALF_H, PITCH_LINE_DEPTH, 1.0f, 1.0f, 1.0f, 1.0f},
+    {PITCH_HALF_W, -PITCH_HALF_H, PITCH_LINE_DEPTH, 1.0f, 1.0f, 1.0f, 1.0f},
+    {PITCH_HALF_W, PITCH_HALF_H, PITCH_LINE_DEPTH, 1.0f, 1.0f, 1.0f, 1.0f}
+};
+
+static const char vertexShaderSource[] = 
+    "uniform mat4 uProjectionMatrix;\n"
+    "uniform vec4 uOffsetScale;\n"   // xyz offset, w uniform scale
+    "attribute vec4 aPosition;\n"
+    "attribute vec4 aColor;\n"
+    "varying vec4 vColor;\n"
+    "void main() {\n"
+    "   gl_Position = uProjectionMatrix * vec4(aPosition.xyz * uOffsetScale.w + uOffsetScale.xyz, 1.0);\n"
+    "   vColor = aColor;\n"
+    "}\n";
+
+static const char fragmentShaderSource[] = 
+    "precision mediump float;\n"
+    "varying vec4 vColor;\n"
+    "void main() {\n"
+    "   gl_FragColor = vColor;\n"
+    "}\n";
+
+static GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    
+    GLint compileStatus;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compileStatus);
+    if (!compileStatus) {
+        GLchar infoLog[512];
+        glGetShaderInfoLog(shader, sizeof(infoLog), nullptr, infoLog);
+        LOGE("Shader compilation failed: %s", infoLog);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+static GLuint createProgram() {
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
+    
+    if (!vertexShader || !fragmentShader) {
+        return 0;
+    }
+    
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    
+    GLint linkStatus;
+    glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+    if (!linkStatus) {
+        GLchar infoLog[512];
+        glGetProgramInfoLog(program, sizeof(infoLog), nullptr, infoLog);
+        LOGE("Program linking failed: %s", infoLog);
+        glDeleteProgram(program);
+        program = 0;
+    }
+    
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    
+    return program;
+}
+
+bool initRenderer(GameState* state) {
+    state->program = createProgram();
+    if (!state->program) {
+        return false;
+    }
+    state->projectionLoc = glGetUniformLocation(state->program, "uProjectionMatrix");
+    state->offsetScaleLoc = glGetUniformLocation(state->program, "uOffsetScale");
+    state->positionLoc = glGetAttribLocation(state->program, "aPosition");
+    state->colorLoc = glGetAttribLocation(state->program, "aColor");
+    
+    state->discardFramebuffer = nullptr;
+    const char* extensions = reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+    if (extensions && strstr(extensions, "GL_EXT_discard_framebuffer")) {
+        state->discardFramebuffer = reinterpret_cast<PFNGLDISCARDFRAMEBUFFEREXTPROC>(
+            eglGetProcAddress("glDiscardFramebufferEXT"));
+    }
+    return true;
+}
+
+void updateProjectionMatrix(GameState* state) {
+    float left = -state->fieldWidth / 2.0f / state->viewZoom;
+    float right = state->fieldWidth / 2.0f / state->viewZoom;
+    float bottom = -state->fieldHeight / 2.0f / state->viewZoom;
+    float top = state->fieldHeight / 2.0f / state->viewZoom;
+    float near = -10.0f;
+    float far = 10.0f;
+    
+    float* m = state->projectionMatrix;
+    
+    m[0] = 2.0f / (right - left);
+    m[1] = 0.0f;
+    m[2] = 0.0f;
+    m[3] = 0.0f;
+    
+    m[4] = 0.0f;
+    m[5] = 2.0f / (top - bottom);
+    m[6] = 0.0f;
+    m[7] = 0.0f;
+    
+    m[8] = 0.0f;
+    m[9] = 0.0f;
+    m[10] = -2.0f / (far - near);
+    m[11] = 0.0f;
+    
+    m[12] = -(right + left) / (right - left);
+    m[13] = -(top + bottom) / (top - bottom);
+    m[14] = -(far + near) / (far - near);
+    m[15] = 1.0f;
+}
+
+void initGame(GameState* state) {
+    state->fieldWidth = PITCH_WIDTH;
+    state->fieldHeight = PITCH_HEIGHT;
+    state->boundaryMargin = PITCH_MARGIN;
+    
+    // Initialize players
+    state->player1 = {0.0f, -state->fieldHeight/2 + 2.0f, 0.0f, 0.5f, {1.0f, 0.0f, 0.0f, 1.0f}, 0.1f};
+    state->player2 = {0.0f, state->fieldHeight/2 - 2.0f, 0.0f, 0.5f, {0.0f, 0.0f, 1.0f, 1.0f}, 0.1f};
+    
+    // Initialize ball
+    state->ball = {0.0f, 0.0f, 0.0f, 0.3f, {1.0f, 1.0f, 1.0f, 1.0f}, 0.05f, 0.05f};
+    
+    state->steeredPlayer = nullptr;
+    state->dragging = false;
+    state->zoom = 1.0f;
+    state->viewZoom = 1.0f;
+    
+    updateProjectionMatrix(state);
+    
+    LOGI("Game initialized");
+}
+
+static Player* nearestPlayer(GameState* state, float x, float y) {
+    float dist1 = sqrt(pow(x - state->player1.x, 2) + pow(y - state->player1.y, 2));
+    float dist2 = sqrt(pow(x - state->player2.x, 2) + pow(y - state->player2.y, 2));
+    return (dist1 < dist2) ? &state->player1 : &state->player2;
+}
+
+// Applies the gestures queued before stepStart. A drag steers the
+// player nearest to where it started, a tap sends the nearest player
+// there, a swipe starting at the ball kicks it and a pinch zooms.
+static void applyGestures(GameState* state, std::chrono::steady_clock::time_point stepStart) {
+    while (const Gesture* next = state->gestureQueue.peek()) {
+        if (next->time > stepStart) {
+            break;   // Arrived during this step; the next one takes it
+        }
+        Gesture gesture;
+        if (!state->gestureQueue.pop(gesture)) {
+            break;
+        }
+        switch (gesture.type) {
+            case GESTURE_TAP:
+            case GESTURE_DRAG_BEGIN:
+                state->steeredPlayer = nearestPlayer(state, gesture.x, gesture.y);
+                state->dragging = gesture.type == GESTURE_DRAG_BEGIN;
+                state->targetX = gesture.x;
+                state->targetY = gesture.y;
+                break;
+            case GESTURE_DRAG:
+                state->targetX = gesture.x;
+                state->targetY = gesture.y;
+                break;
+            case GESTURE_DRAG_END:
+                state->steeredPlayer = nullptr;
+                state->dragging = false;
+                break;
+            case GESTURE_SWIPE: {
+                float dx = gesture.x - state->ball.x;
+                float dy = gesture.y - state->ball.y;
+                if (dx * dx + dy * dy <= BALL_KICK_REACH * BALL_KICK_REACH) {
+                    // Swipe velocity is per second, the ball's per step
+                    float step = std::chrono::duration<float>(SIM_STEP_INTERVAL).count();
+                    float vx = gesture.vx * step;
+                    float vy = gesture.vy * step;
+                    float speed = sqrt(vx * vx + vy * vy);
+                    if (speed > BALL_MAX_KICK_SPEED) {
+                        vx *= BALL_MAX_KICK_SPEED / speed;
+                        vy *= BALL_MAX_KICK_SPEED / speed;
+                    }
+                    state->ball.velocityX = vx;
+                    state->ball.velocityY = vy;
+                }
+                break;
+            }
+            case GESTURE_PINCH:
+                state->zoom = fmax(MIN_ZOOM, fmin(MAX_ZOOM, state->zoom * gesture.scale));
+                break;
+        }
+    }
+}
+
+void screenToGame(const GameState* state, float screenX, float screenY, float& x, float& y) {
+    x = (screenX / state->width - 0.5f) * state->fieldWidth / state->viewZoom;
+    y = (0.5f - screenY / state->height) * state->fieldHeight / state->viewZoom;
+}
+
+void updateGame(GameState* state, std::chrono::steady_clock::time_point stepStart) {
+    applyGestures(state, stepStart);
+    
+    // Move ball
+    state->ball.x += state->ball.velocityX;
+    state->ball.y += state->ball.velocityY;
+    
+    // Ball boundary collision
+    float halfW = state->fieldWidth / 2.0f - state->boundaryMargin;
+    float halfH = state->fieldHeight / 2.0f - state->boundaryMargin;
+    
+    if (state->ball.x - state->ball.radius < -halfW || 
+        state->ball.x + state->ball.radius > halfW) {
+        state->ball.velocityX = -state->ball.velocityX;
+    }
+    
+    if (state->ball.y - state->ball.radius < -halfH || 
+        state->ball.y + state->ball.radius > halfH) {
+        state->ball.velocityY = -state->ball.velocityY;
+    }
+    
+    // Move the steered player toward its target
+    Player* targetPlayer = state->steeredPlayer;
+    if (targetPlayer) {
+        // Calculate direction to touch point
+        float dx = state->targetX - targetPlayer->x;
+        float dy = state->targetY - targetPlayer->y;
+        float distance = sqrt(dx * dx + dy * dy);
+        
+        if (distance <= 0.1f && !state->dragging) {
+            state->steeredPlayer = nullptr;   // A tap's run is over
+        } else if (distance > 0.1f) {
+            dx /= distance;
+            dy /= distance;
+            
+            // Move player
+            targetPlayer->x += dx * targetPlayer->speed;
+            targetPlayer->y += dy * targetPlayer->speed;
+            
+            // Keep player within boundaries
+            float playerHalfSize = targetPlayer->size / 2.0f;
+            targetPlayer->x = fmax(-halfW + playerHalfSize, fmin(halfW - playerHalfSize, targetPlayer->x));
+            targetPlayer->y = fmax(-halfH + playerHalfSize, fmin(halfH - playerHalfSize, targetPlayer->y));
+        }
+    }
+}
+
+void publishMatchView(GameState* state) {
+    MatchView& view = state->matchViews.writeBuffer();
+    view.player1 = state->player1;
+    view.player2 = state->player2;
+    view.ball = state->ball;
+    view.zoom = state->zoom;
+    state->matchViews.publish();
+}
+
+// Runs updateGame at a fixed rate until stopSimulation. A step that
+// overruns is not caught up on.
+static void simulationLoop(GameState* state) {
+    auto nextStep = std::chrono::steady_clock::now();
+    while (state->simRunning.load(std::memory_order_acquire)) {
+        updateGame(state, std::chrono::steady_clock::now());
+        publishMatchView(state);
+        
+        nextStep += SIM_STEP_INTERVAL;
+        auto now = std::chrono::steady_clock::now();
+        if (nextStep < now) {
+            nextStep = now;
+        }
+        std::this_thread::sleep_until(nextStep);
+    }
+}
+
+void startSimulation(GameState* state) {
+    publishMatchView(state);
+    state->simRunning.store(true, std::memory_order_release);
+    state->simThread = std::thread(simulationLoop, state);
+}
+
+void stopSimulation(GameState* state) {
+    if (state->simThread.joinable()) {
+        state->simRunning.store(false, std::memory_order_release);
+        state->simThread.join();
+    }
+}
+
+// One opaque indexed mesh placed by uOffsetScale
+struct OpaqueDraw {
+    float x, y, z, scale;
+    const float* color;
+    const MeshPosition* positions;
+    const GLushort* indices;
+    GLsizei indexCount;
+};
+
+void renderGame(GameState* state) {
+    // Newest simulation step; the previous one if none finished since
+    state->matchViews.update();
+    const MatchView& view = state->matchViews.read();
+    if (view.zoom != state->viewZoom) {
+        state->viewZoom = view.zoom;
+        updateProjectionMatrix(state);
+    }
+    
+    glClearColor(0.0f, 0.0f, 0.1f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    
+    glEnable(GL_DEPTH_TEST);
+    glUseProgram(state->program);
+    
+    glUniformMatrix4fv(state->projectionLoc, 1, GL_FALSE, state->projectionMatrix);
+    
+    GLint positionLoc = state->positionLoc;
+    GLint colorLoc = state->colorLoc;
+    
+    glEnableVertexAttribArray(positionLoc);
+    
+    // Players and ball take their colour from the constant attribute. They
+    // are drawn nearest first (the camera looks down -z) and before the
+    // pitch, so the depth test rejects hidden pitch fragments before shading.
+    glDisableVertexAttribArray(colorLoc);
+    
+    OpaqueDraw draws[] = {
+        {view.player1.x, view.player1.y, view.player1.z, view.player1.size, view.player1.color,
+         CUBE_POSITIONS.data(), CUBE_INDICES.data(), CUBE_INDICES.size()},
+        {view.player2.x, view.player2.y, view.player2.z, view.player2.size, view.player2.color,
+         CUBE_POSITIONS.data(), CUBE_INDICES.data(), CUBE_INDICES.size()},
+        {view.ball.x, view.ball.y, view.ball.z, view.ball.radius, view.ball.color,
+         SPHERE_POSITIONS.data(), SPHERE_INDICES.data(), SPHERE_INDICES.size()}
+    };
+    std::sort(std::begin(draws), std::end(draws),
+              [](const OpaqueDraw& a, const OpaqueDraw& b) { return a.z > b.z; });
+    
+    for (const OpaqueDraw& draw : draws) {
+        glUniform4f(state->offsetScaleLoc, draw.x, draw.y, draw.z, draw.scale);
+        glVertexAttrib4fv(colorLoc, draw.color);
+        glVertexAttribPointer(positionLoc, 3, GL_FLOAT, GL_FALSE, sizeof(MeshPosition), draw.positions);
+        glDrawElements(GL_TRIANGLES, draw.indexCount, GL_UNSIGNED_SHORT, draw.indices);
+    }
+    
+    // Render field
+    glEnableVertexAttribArray(colorLoc);
+    glUniform4f(state->offsetScaleLoc, 0.0f, 0.0f, 0.0f, 1.0f);
+    glVertexAttribPointer(positionLoc, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), 
+                         &FIELD_VERTICES[0].x);
+    glVertexAttribPointer(colorLoc, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), 
+                         &FIELD_VERTICES[0].r);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);  // Field surface
+    
+    glDrawArrays(GL_LINES, 4, 8);  // Field boundaries
+    
+    // Depth is never read back: let tilers skip writing it out to memory
+    if (state->discardFramebuffer) {
+        const GLenum depthAttachment = GL_DEPTH_EXT;
+        state->discardFramebuffer(GL_FRAMEBUFFER, 1, &depthAttachment);
+    }
+}
+
+void shutdownGame(GameState* state) {
+    stopSimulation(state);
+    if (state->program) {
+        glDeleteProgram(state->program);
+        state->program = 0;
+    }
+    state->initialized = false;
+    LOGI("Game shutdown");
+}
+
+void flushGestures(GameState* state) {
+    state->gestures.flush([state](const Gesture& gesture) {
+        // Full only if the simulation is stalled; dropping beats blocking input
+        state->gestureQueue.push(gesture);
+    });
+}
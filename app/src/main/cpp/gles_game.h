@@ -0,0 +1,115 @@
+#pragma once
+
+#include <EGL/egl.h>
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "gestures.h"
+#include "spsc_queue.h"
+#include "triple_buffer.h"
+
+// The GLES2 game, independent of how its context, window and input arrive:
+// main.cpp drives it from android_native_app_glue, bench/gles_bench.cpp
+// from an EGL pbuffer on the desktop.
+
+struct Vertex {
+    float x, y, z;
+    float r, g, b, a;
+};
+
+struct Player {
+    float x, y, z;
+    float size;
+    float color[4];
+    float speed;
+};
+
+struct Ball {
+    float x, y, z;
+    float radius;
+    float color[4];
+    float velocityX, velocityY;
+};
+
+// What a frame draws: an immutable copy of the simulation's objects
+struct MatchView {
+    Player player1;
+    Player player2;
+    Ball ball;
+    float zoom;
+};
+
+constexpr size_t GESTURE_QUEUE_CAPACITY = 128;   // Gestures between two simulation steps
+
+// Simulation thread rate. Speeds are per update and tuned for 60 a second.
+constexpr std::chrono::microseconds SIM_STEP_INTERVAL{16667};
+
+struct GameState {
+    EGLDisplay display;
+    EGLSurface surface;
+    EGLContext context;
+    bool initialized;
+    int width, height;
+    float aspectRatio;
+
+    GLuint program;
+    GLuint vertexBuffer;
+    GLint projectionLoc;
+    GLint offsetScaleLoc;
+    GLint positionLoc;
+    GLint colorLoc;
+    PFNGLDISCARDFRAMEBUFFEREXTPROC discardFramebuffer;   // Null without EXT_discard_framebuffer
+
+    // Owned by the simulation thread while it runs
+    Player player1;
+    Player player2;
+    Ball ball;
+
+    std::thread simThread;
+    std::atomic<bool> simRunning;
+    TripleBuffer<MatchView> matchViews;
+
+    // Input handling feeds every touch sample to the recognizer and flushes
+    // it once per frame into the queue; the simulation applies the gestures
+    // at the start of each step to the control state below
+    GestureRecognizer gestures;
+    SpscQueue<Gesture, GESTURE_QUEUE_CAPACITY> gestureQueue;
+    Player* steeredPlayer;   // Runs to the target: while dragged, or until it gets there after a tap
+    bool dragging;
+    float targetX, targetY;
+    float zoom;
+    float viewZoom;          // Zoom of the projection matrix, render thread
+
+    float fieldWidth, fieldHeight;
+    float boundaryMargin;
+
+    float projectionMatrix[16];
+};
+
+// With the context current: program, its locations and the extensions the
+// renderer uses. False if the shaders did not build.
+bool initRenderer(GameState* state);
+void updateProjectionMatrix(GameState* state);
+void initGame(GameState* state);
+
+// Surface pixels, y down, to pitch units through the current zoom
+void screenToGame(const GameState* state, float screenX, float screenY, float& x, float& y);
+
+// One simulation step, applying the gestures queued before stepStart
+void updateGame(GameState* state, std::chrono::steady_clock::time_point stepStart);
+void publishMatchView(GameState* state);
+
+// updateGame on its own thread at SIM_STEP_INTERVAL
+void startSimulation(GameState* state);
+void stopSimulation(GameState* state);
+
+// Once per frame, after the frame's input events: hands what the
+// recognizer made of them to the simulation
+void flushGestures(GameState* state);
+
+// Draws the newest match view; the caller swaps buffers
+void renderGame(GameState* state);
+void shutdownGame(GameState* state);
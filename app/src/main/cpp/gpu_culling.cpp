@@ -0,0 +1,228 @@
+#include "gpu_culling.h"
+
+#include <stdexcept>
+
+const uint32_t CULL_WORKGROUP_SIZE = 64;   // local_size_x in shaders/cull.comp
+
+// Push constants of shaders/cull.comp
+struct CullPushConstants {
+    Plane planes[6];
+    uint32_t count;
+};
+
+void GpuCuller::create(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t maxInstances,
+                       uint32_t framesInFlight) {
+    this->device = device;
+    this->physicalDevice = physicalDevice;
+    this->maxInstances = maxInstances;
+
+    // Instances, visible list and indirect command; the vertex shader reads
+    // the first two
+    VkDescriptorSetLayoutBinding bindings[3]{};
+    for (uint32_t i = 0; i < 3; i++) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = i < 2 ? VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT : VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 3;
+    layoutInfo.pBindings = bindings;
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &setLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create culling descriptor set layout!");
+    }
+
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = 3 * framesInFlight;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = framesInFlight;
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create culling descriptor pool!");
+    }
+
+    VkDeviceSize instanceSize = sizeof(GpuCullInstance) * maxInstances;
+    VkDeviceSize visibleSize = sizeof(uint32_t) * maxInstances;
+    VkDeviceSize commandSize = sizeof(VkDrawIndexedIndirectCommand);
+
+    frames.resize(framesInFlight);
+    for (Frame& frame : frames) {
+        createBuffer(instanceSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                     frame.instanceBuffer, frame.instanceMemory);
+        vkMapMemory(device, frame.instanceMemory, 0, instanceSize, 0, reinterpret_cast<void**>(&frame.mapped));
+
+        createBuffer(visibleSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                     frame.visibleBuffer, frame.visibleMemory);
+        createBuffer(commandSize,
+                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                     VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, frame.commandBuffer, frame.commandMemory);
+
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = descriptorPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &setLayout;
+        if (vkAllocateDescriptorSets(device, &allocInfo, &frame.descriptorSet) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate culling descriptor set!");
+        }
+
+        VkDescriptorBufferInfo bufferInfos[3] = {
+            {frame.instanceBuffer, 0, VK_WHOLE_SIZE},
+            {frame.visibleBuffer, 0, VK_WHOLE_SIZE},
+            {frame.commandBuffer, 0, VK_WHOLE_SIZE}
+        };
+        VkWriteDescriptorSet writes[3]{};
+        for (uint32_t i = 0; i < 3; i++) {
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet = frame.descriptorSet;
+            writes[i].dstBinding = i;
+            writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[i].descriptorCount = 1;
+            writes[i].pBufferInfo = &bufferInfos[i];
+        }
+        vkUpdateDescriptorSets(device, 3, writes, 0, nullptr);
+    }
+
+    // Compute pipeline
+    static constexpr uint32_t cullShaderCode[] = {
+        #include "cull.comp.spv"
+    };
+
+    VkShaderModuleCreateInfo moduleInfo{};
+    moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleInfo.codeSize = sizeof(cullShaderCode);
+    moduleInfo.pCode = cullShaderCode;
+    VkShaderModule cullModule;
+    if (vkCreateShaderModule(device, &moduleInfo, nullptr, &cullModule) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create culling shader module!");
+    }
+
+    VkPushConstantRange pushRange{};
+    pushRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushRange.offset = 0;
+    pushRange.size = sizeof(CullPushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &setLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushRange;
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &cullLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create culling pipeline layout!");
+    }
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = cullModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = cullLayout;
+    if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &cullPipeline) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create culling pipeline!");
+    }
+
+    vkDestroyShaderModule(device, cullModule, nullptr);
+}
+
+void GpuCuller::destroy() {
+    for (Frame& frame : frames) {
+        vkUnmapMemory(device, frame.instanceMemory);
+        vkDestroyBuffer(device, frame.instanceBuffer, nullptr);
+        vkFreeMemory(device, frame.instanceMemory, nullptr);
+        vkDestroyBuffer(device, frame.visibleBuffer, nullptr);
+        vkFreeMemory(device, frame.visibleMemory, nullptr);
+        vkDestroyBuffer(device, frame.commandBuffer, nullptr);
+        vkFreeMemory(device, frame.commandMemory, nullptr);
+    }
+    frames.clear();
+
+    vkDestroyPipeline(device, cullPipeline, nullptr);
+    vkDestroyPipelineLayout(device, cullLayout, nullptr);
+    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+}
+
+void GpuCuller::recordReset(VkCommandBuffer commandBuffer, uint32_t frame, const MeshRange& mesh) {
+    // Start from an empty draw of the mesh; the shader counts instances in
+    VkDrawIndexedIndirectCommand reset{};
+    reset.indexCount = mesh.indexCount;
+    reset.instanceCount = 0;
+    reset.firstIndex = mesh.firstIndex;
+    reset.vertexOffset = mesh.vertexOffset;
+    reset.firstInstance = 0;
+    vkCmdUpdateBuffer(commandBuffer, frames[frame].commandBuffer, 0, sizeof(reset), &reset);
+}
+
+void GpuCuller::recordDispatch(VkCommandBuffer commandBuffer, uint32_t frame, uint32_t count, const Frustum& frustum) {
+    Frame& f = frames[frame];
+    if (count > maxInstances) {
+        count = maxInstances;
+    }
+
+    CullPushConstants push{};
+    for (int i = 0; i < 6; i++) {
+        push.planes[i] = frustum.planes[i];
+    }
+    push.count = count;
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullLayout, 0, 1, &f.descriptorSet, 0,
+                            nullptr);
+    vkCmdPushConstants(commandBuffer, cullLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push), &push);
+    vkCmdDispatch(commandBuffer, (count + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+}
+
+void GpuCuller::recordDraw(VkCommandBuffer commandBuffer, VkPipelineLayout layout, uint32_t frame) {
+    Frame& f = frames[frame];
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1, &f.descriptorSet, 0,
+                            nullptr);
+    vkCmdDrawIndexedIndirect(commandBuffer, f.commandBuffer, 0, 1, sizeof(VkDrawIndexedIndirectCommand));
+}
+
+void GpuCuller::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+                             VkBuffer& buffer, VkDeviceMemory& memory) {
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create culling buffer!");
+    }
+
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(device, buffer, &requirements);
+
+    VkPhysicalDeviceMemoryProperties memProperties;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+    uint32_t typeIndex = UINT32_MAX;
+    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
+        if ((requirements.memoryTypeBits & (1u << i)) &&
+            (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            typeIndex = i;
+            break;
+        }
+    }
+    if (typeIndex == UINT32_MAX) {
+        throw std::runtime_error("failed to find suitable memory type!");
+    }
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = requirements.size;
+    allocInfo.memoryTypeIndex = typeIndex;
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate culling buffer memory!");
+    }
+    vkBindBufferMemory(device, buffer, memory, 0);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "frustum.h"
+#include "meshes.h"
+#include "simd_math.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+// Per-instance data shared with shaders/cull.comp and shaders/scene.vert
+// (std430 layout)
+struct GpuCullInstance {
+    Mat4 model;
+    Vec4 color;
+    Vec4 sphere;    // xyz centre, w radius
+};
+
+// GPU-driven culling for one mesh drawn many times. A compute pass tests every
+// instance's bounding sphere against the frustum, appends the survivors to a
+// visible list and counts them into a single VkDrawIndexedIndirectCommand, so
+// thousands of instances cost one dispatch and one indirect draw on the CPU.
+//
+// Only a drawCount of 1 is used and the count lives in instanceCount, so the
+// path needs neither multiDrawIndirect nor drawIndirectCount and runs on
+// software drivers such as lavapipe.
+class GpuCuller {
+public:
+    void create(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t maxInstances, uint32_t framesInFlight);
+    void destroy();
+
+    // Persistently mapped instance array for a frame slot; fill it before recordDispatch
+    GpuCullInstance* instances(uint32_t frame) { return frames[frame].mapped; }
+    uint32_t capacity() const { return maxInstances; }
+
+    // The three steps of a frame, which the caller has to order with
+    // barriers (the frame graph derives them from the declared accesses):
+    // recordReset writes the draw command with a transfer, recordDispatch
+    // reads and writes it and the visible list from a compute shader, and
+    // recordDraw reads the command as an indirect draw and the visible list
+    // from the vertex shader.
+
+    // Outside a render pass: an empty draw of the mesh
+    void recordReset(VkCommandBuffer commandBuffer, uint32_t frame, const MeshRange& mesh);
+
+    // Outside a render pass: culls the first `count` instances
+    void recordDispatch(VkCommandBuffer commandBuffer, uint32_t frame, uint32_t count, const Frustum& frustum);
+
+    // Inside the render pass, with a pipeline created from drawSetLayout() at
+    // set 0 and the mesh's vertex and index buffers bound
+    void recordDraw(VkCommandBuffer commandBuffer, VkPipelineLayout layout, uint32_t frame);
+
+    VkDescriptorSetLayout drawSetLayout() const { return setLayout; }
+
+private:
+    struct Frame {
+        VkBuffer instanceBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory instanceMemory = VK_NULL_HANDLE;
+        GpuCullInstance* mapped = nullptr;
+        VkBuffer visibleBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory visibleMemory = VK_NULL_HANDLE;
+        VkBuffer commandBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory commandMemory = VK_NULL_HANDLE;
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    };
+
+    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+                      VkBuffer& buffer, VkDeviceMemory& memory);
+
+    VkDevice device = VK_NULL_HANDLE;
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    uint32_t maxInstances = 0;
+    std::vector<Frame> frames;
+
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkPipelineLayout cullLayout = VK_NULL_HANDLE;
+    VkPipeline cullPipeline = VK_NULL_HANDLE;
+};
@@ -0,0 +1,253 @@
+#include "job_system.h"
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <utility>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+// A core slower than this fraction of the fastest one is a slow tier, and
+// cores within the same fraction of the slowest belong to it
+const double SLOW_TIER_RATIO = 0.8;
+
+// Pool and worker the calling thread belongs to, if any
+static thread_local const JobSystem* currentSystem = nullptr;
+static thread_local unsigned currentWorker = 0;
+
+#ifdef __linux__
+// One value per CPU from /sys/devices/system/cpu/cpu<N>/<name>, or false
+// if any CPU lacks it
+static bool readCpuValues(const char* name, unsigned cpuCount, std::vector<std::pair<long, int>>& values) {
+    values.clear();
+    for (unsigned cpu = 0; cpu < cpuCount; cpu++) {
+        std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/" + name);
+        long value = 0;
+        if (!(file >> value) || value <= 0) {
+            return false;
+        }
+        values.push_back({value, static_cast<int>(cpu)});
+    }
+    return true;
+}
+#endif
+
+CpuTopology detectCpuTopology() {
+    CpuTopology topology;
+    topology.logicalCores = std::max(1u, std::thread::hardware_concurrency());
+#ifdef __linux__
+    // (performance, cpu): the scheduler's capacity where the kernel exposes
+    // it (arm64), otherwise the maximum frequency in kHz
+    std::vector<std::pair<long, int>> cores;
+    if (!readCpuValues("cpu_capacity", topology.logicalCores, cores) &&
+        !readCpuValues("cpufreq/cpuinfo_max_freq", topology.logicalCores, cores)) {
+        return topology;   // Neither: leave placement to the scheduler
+    }
+    std::sort(cores.begin(), cores.end(), [](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+
+    // Turbo bins and binning spread make cores of one tier report slightly
+    // different limits; only a clear gap makes a slow tier
+    long fastest = cores.front().first;
+    long slowest = cores.back().first;
+    topology.heterogeneous = slowest < fastest * SLOW_TIER_RATIO;
+    for (const auto& [performance, cpu] : cores) {
+        if (!topology.heterogeneous || performance * SLOW_TIER_RATIO > slowest) {
+            topology.jobCores.push_back(cpu);
+        }
+    }
+#endif
+    return topology;
+}
+
+JobSystem::JobSystem(unsigned workerCount) {
+    CpuTopology topology = detectCpuTopology();
+    if (workerCount == 0) {
+        size_t cores = topology.jobCores.empty() ? topology.logicalCores : topology.jobCores.size();
+        workerCount = cores > 1 ? static_cast<unsigned>(cores) - 1 : 0;
+    }
+
+    // Only keep workers off the little cores; among the others the
+    // scheduler balances better than fixed pinning would
+    std::vector<int> affinity;
+    if (topology.heterogeneous) {
+        affinity = topology.jobCores;
+    }
+
+    for (unsigned i = 0; i < workerCount; i++) {
+        queues.push_back(std::make_unique<Worker>());
+    }
+    for (unsigned i = 0; i < workerCount; i++) {
+        workers.emplace_back(&JobSystem::workerLoop, this, i, affinity);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void JobSystem::run(std::function<void()> fn, JobCounter* counter) {
+    if (counter) {
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    Job job = {std::move(fn), counter};
+    if (queues.empty()) {
+        execute(job);
+        return;
+    }
+    push(std::move(job));
+}
+
+void JobSystem::runAfter(JobCounter& dependency, std::function<void()> fn, JobCounter* counter) {
+    if (counter) {
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard<std::mutex> lock(dependency.mutex);
+        if (dependency.pending.load(std::memory_order_acquire) != 0) {
+            dependency.continuations.push_back({std::move(fn), counter});
+            return;
+        }
+    }
+    Job job = {std::move(fn), counter};
+    if (queues.empty()) {
+        execute(job);
+        return;
+    }
+    push(std::move(job));
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    while (!counter.done()) {
+        if (!tryRun()) {
+            std::this_thread::yield();
+        }
+    }
+    // The job that finished last may still hold the lock; once it lets go
+    // the caller is free to destroy the counter
+    std::lock_guard<std::mutex> lock(counter.mutex);
+}
+
+void JobSystem::push(Job job) {
+    Worker& queue = currentSystem == this
+        ? *queues[currentWorker]
+        : *queues[nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size()];
+    // Counted before it is queued, so the count never drops below zero
+    queued.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+
+    // Pairs with the check in workerLoop: either the worker sees the job or
+    // this sees the worker asleep
+    if (sleeping.load() > 0) {
+        { std::lock_guard<std::mutex> lock(sleepMutex); }
+        wake.notify_one();
+    }
+}
+
+bool JobSystem::pop(Job& job) {
+    if (queued.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+
+    // The newest own job first, its data is likely still in cache; then the
+    // oldest job of each other worker, which tends to be the largest
+    size_t count = queues.size();
+    size_t first = 0;
+    if (currentSystem == this) {
+        Worker& own = *queues[currentWorker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty()) {
+            job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        first = currentWorker + 1;
+    }
+    for (size_t k = 0; k < count; k++) {
+        Worker& victim = *queues[(first + k) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JobSystem::tryRun() {
+    Job job;
+    if (!pop(job)) {
+        return false;
+    }
+    execute(job);
+    return true;
+}
+
+void JobSystem::execute(Job& job) {
+    job.fn();
+    if (!job.counter) {
+        return;
+    }
+
+    // Decrement under the lock so runAfter never adds a continuation that
+    // nobody starts
+    std::vector<JobCounter::Continuation> ready;
+    {
+        std::lock_guard<std::mutex> lock(job.counter->mutex);
+        if (job.counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            ready.swap(job.counter->continuations);
+        }
+    }
+    for (auto& continuation : ready) {
+        Job next = {std::move(continuation.fn), continuation.counter};
+        if (queues.empty()) {
+            execute(next);
+        } else {
+            push(std::move(next));
+        }
+    }
+}
+
+void JobSystem::workerLoop(unsigned index, [[maybe_unused]] std::vector<int> affinity) {
+    currentSystem = this;
+    currentWorker = index;
+#ifdef __linux__
+    if (!affinity.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int core : affinity) {
+            CPU_SET(core, &set);
+        }
+        sched_setaffinity(0, sizeof(set), &set);   // Best effort
+    }
+#endif
+
+    while (true) {
+        if (tryRun()) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleeping.fetch_add(1);
+        wake.wait(lock, [this] { return stopping || queued.load() > 0; });
+        sleeping.fetch_sub(1);
+        if (stopping) {
+            return;
+        }
+    }
+}
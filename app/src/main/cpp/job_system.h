@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Cores worth running jobs on. On big.LITTLE parts the slowest tier is left
+// out: a parallel_for is only as fast as its last chunk, and a chunk on a
+// little core finishes long after the rest.
+struct CpuTopology {
+    unsigned logicalCores = 0;
+    std::vector<int> jobCores;      // CPU ids, fastest tier first; empty if unknown
+    bool heterogeneous = false;     // The slowest core is well below the fastest
+};
+
+// Reads each core's cpu_capacity, or failing that its cpufreq limit, from
+// sysfs on Linux and Android; elsewhere only the core count is known
+CpuTopology detectCpuTopology();
+
+// Counts outstanding jobs. A job started with a counter increments it and
+// decrements it when it finishes; wait() on it, or start other jobs after it.
+class JobCounter {
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    struct Continuation {
+        std::function<void()> fn;
+        JobCounter* counter;
+    };
+
+    std::atomic<uint32_t> pending{0};
+    std::mutex mutex;
+    std::vector<Continuation> continuations;   // Started when pending next reaches zero
+};
+
+// Work-stealing job system without fibers. Each worker owns a deque: it
+// pushes and pops its own jobs at the back, and idle workers steal from the
+// front of the others'. Jobs started from outside the pool are spread over
+// the workers. A thread that waits on a counter runs jobs until it is done
+// instead of blocking, so jobs can start and wait for jobs of their own.
+class JobSystem {
+public:
+    // 0 workers: one per job core (see CpuTopology) less the calling thread,
+    // which joins in whenever it waits. Workers are pinned to the job cores.
+    explicit JobSystem(unsigned workerCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    unsigned workerCount() const { return static_cast<unsigned>(workers.size()); }
+
+    void run(std::function<void()> fn, JobCounter* counter = nullptr);
+
+    // Starts fn once dependency has no outstanding jobs left
+    void runAfter(JobCounter& dependency, std::function<void()> fn, JobCounter* counter = nullptr);
+
+    // Runs jobs until the counter reaches zero
+    void wait(JobCounter& counter);
+
+    // Calls fn(begin, end) over [0, count) in ranges of at most grainSize
+    // and returns once all of them are done. A single range runs inline.
+    template <typename Fn>
+    void parallelFor(uint32_t count, uint32_t grainSize, Fn&& fn) {
+        if (grainSize == 0) {
+            grainSize = 1;
+        }
+        if (count <= grainSize) {
+            if (count > 0) {
+                fn(0u, count);
+            }
+            return;
+        }
+        JobCounter counter;
+        for (uint32_t begin = 0; begin < count; begin += grainSize) {
+            uint32_t end = count - begin > grainSize ? begin + grainSize : count;
+            run([&fn, begin, end] { fn(begin, end); }, &counter);
+        }
+        wait(counter);
+    }
+
+private:
+    struct Job {
+        std::function<void()> fn;
+        JobCounter* counter;
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    void push(Job job);
+    bool tryRun();
+    bool pop(Job& job);
+    void execute(Job& job);
+    void workerLoop(unsigned index, std::vector<int> affinity);
+
+    std::vector<std::unique_ptr<Worker>> queues;   // One per worker
+    std::vector<std::thread> workers;
+    std::atomic<uint32_t> nextQueue{0};            // Round robin for outside threads
+
+    std::atomic<uint32_t> queued{0};
+    std::atomic<uint32_t> sleeping{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
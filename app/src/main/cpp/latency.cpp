@@ -0,0 +1,117 @@
+#include "latency.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <string>
+
+// Widest bar of the printed histograms
+const int LATENCY_BAR_WIDTH = 50;
+
+void LatencyHistogram::add(std::chrono::nanoseconds latency) {
+    int64_t micros = std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+    uint64_t bucket = std::min<uint64_t>(static_cast<uint64_t>(micros) / BUCKET_MICROS, BUCKETS);
+    buckets[bucket]++;
+    samples++;
+    totalMicros += micros;
+    maxMicros = std::max(maxMicros, micros);
+}
+
+std::chrono::microseconds LatencyHistogram::percentile(double p) const {
+    if (samples == 0) {
+        return std::chrono::microseconds(0);
+    }
+    uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(samples - 1)) + 1;
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < BUCKETS; b++) {
+        seen += buckets[b];
+        if (seen >= rank) {
+            return std::chrono::microseconds(std::min<int64_t>((b + 1) * BUCKET_MICROS, maxMicros));
+        }
+    }
+    return std::chrono::microseconds(maxMicros);
+}
+
+std::chrono::microseconds LatencyHistogram::mean() const {
+    return std::chrono::microseconds(samples == 0 ? 0 : totalMicros / static_cast<int64_t>(samples));
+}
+
+void LatencyHistogram::print(std::ostream& out, const char* name) const {
+    auto ms = [](std::chrono::microseconds us) { return us.count() / 1000.0; };
+    out << std::fixed << std::setprecision(1);
+    out << name << ": " << samples << " frames, mean " << ms(mean()) << " ms, p50 " << ms(percentile(0.5))
+        << " ms, p90 " << ms(percentile(0.9)) << " ms, p99 " << ms(percentile(0.99)) << " ms, max "
+        << maxMicros / 1000.0 << " ms\n";
+    if (samples == 0) {
+        return;
+    }
+
+    // Only the populated range, one line per bucket
+    uint32_t first = 0;
+    uint32_t last = BUCKETS;
+    while (buckets[first] == 0) {
+        first++;
+    }
+    while (buckets[last] == 0) {
+        last--;
+    }
+    uint64_t peak = *std::max_element(buckets + first, buckets + last + 1);
+    for (uint32_t b = first; b <= last; b++) {
+        int width = static_cast<int>(buckets[b] * LATENCY_BAR_WIDTH / peak);
+        if (b < BUCKETS) {
+            out << "  " << std::setw(6) << b * BUCKET_MICROS / 1000.0 << " ms ";
+        } else {
+            out << "  " << std::setw(4) << BUCKETS * BUCKET_MICROS / 1000 << "+ ms ";
+        }
+        out << std::string(static_cast<size_t>(width), '#') << ' ' << buckets[b] << '\n';
+    }
+}
+
+void LatencyTracker::frameSubmitted(uint64_t presentId, const Sample& sample) {
+    presentTimed = true;
+    // The oldest entry gives way: its present time is not coming any more
+    Pending* slot = &pending[0];
+    for (Pending& entry : pending) {
+        if (entry.presentId == 0) {
+            slot = &entry;
+            break;
+        }
+        if (entry.presentId < slot->presentId) {
+            slot = &entry;
+        }
+    }
+    *slot = {presentId, sample};
+}
+
+void LatencyTracker::frameSubmittedUntimed(const Sample& sample) {
+    record(sample, sample.submitted);
+}
+
+void LatencyTracker::framePresented(uint64_t presentId, TimePoint presentTime) {
+    for (Pending& entry : pending) {
+        if (entry.presentId == presentId) {
+            record(entry.sample, presentTime);
+            entry.presentId = 0;
+            return;
+        }
+    }
+}
+
+void LatencyTracker::record(const Sample& sample, TimePoint end) {
+    inputToSimulation.add(sample.simulated - sample.input);
+    simulationToSubmit.add(sample.submitted - sample.simulated);
+    if (presentTimed) {
+        submitToPresent.add(end - sample.submitted);
+    }
+    inputToPresent.add(end - sample.input);
+}
+
+void LatencyTracker::print(std::ostream& out) const {
+    inputToSimulation.print(out, "input -> simulation");
+    simulationToSubmit.print(out, "simulation -> submit");
+    if (presentTimed) {
+        submitToPresent.print(out, "submit -> present");
+        inputToPresent.print(out, "input -> present");
+    } else {
+        inputToPresent.print(out, "input -> submit (no present timing)");
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+// Histogram of latencies in fixed 0.5 ms buckets up to 100 ms, plus one for
+// everything slower. Adding is O(1) and never allocates.
+class LatencyHistogram {
+public:
+    void add(std::chrono::nanoseconds latency);
+
+    uint64_t count() const { return samples; }
+    std::chrono::microseconds percentile(double p) const;   // Bucket upper bound (at most the max), p in [0, 1]
+    std::chrono::microseconds mean() const;
+
+    void print(std::ostream& out, const char* name) const;
+
+private:
+    static constexpr uint32_t BUCKET_MICROS = 500;
+    static constexpr uint32_t BUCKETS = 200;
+
+    uint64_t buckets[BUCKETS + 1] = {};   // The last one collects the overflow
+    uint64_t samples = 0;
+    int64_t totalMicros = 0;
+    int64_t maxMicros = 0;
+};
+
+// Follows input through the frame pipeline: when the oldest input a frame
+// reflects was made, when the simulation applied it, when the frame was
+// submitted and when it reached the display. Frames are identified by
+// present id; the present time can arrive frames later, or never (then the
+// frame is dropped from the statistics once the ring wraps).
+class LatencyTracker {
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    struct Sample {
+        TimePoint input;       // Input event stamped by the platform callback
+        TimePoint simulated;   // Start of the simulation step that applied it
+        TimePoint submitted;   // vkQueueSubmit of the first frame showing it
+    };
+
+    // A frame that reflects new input was submitted; presentTime() follows
+    void frameSubmitted(uint64_t presentId, const Sample& sample);
+
+    // When no present timing is available: submit time stands in for it
+    void frameSubmittedUntimed(const Sample& sample);
+
+    void framePresented(uint64_t presentId, TimePoint presentTime);
+
+    void print(std::ostream& out) const;
+
+private:
+    static constexpr uint32_t MAX_PENDING = 32;
+
+    struct Pending {
+        uint64_t presentId;   // 0: free
+        Sample sample;
+    };
+
+    void record(const Sample& sample, TimePoint end);
+
+    Pending pending[MAX_PENDING] = {};
+    bool presentTimed = false;
+
+    LatencyHistogram inputToSimulation;
+    LatencyHistogram simulationToSubmit;
+    LatencyHistogram submitToPresent;
+    LatencyHistogram inputToPresent;
+};
@@ -0,0 +1,239 @@
+#pragma once
+
+// Compile-time mesh generators. Every generator is constexpr, so the standard
+// meshes are baked into read-only data: nothing is built at startup or per
+// frame. Generators produce positions only; each renderer turns them into its
+// own vertex layout with buildVertices.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+struct MeshPosition { float x, y, z; };
+
+constexpr double MESH_PI = 3.14159265358979323846;
+
+// std::sin and std::cos are not constexpr before C++26. After reducing to
+// [-pi, pi] the Taylor series is accurate to well below float precision.
+constexpr double meshSin(double x) {
+    while (x > MESH_PI) {
+        x -= 2.0 * MESH_PI;
+    }
+    while (x < -MESH_PI) {
+        x += 2.0 * MESH_PI;
+    }
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 14; n++) {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double meshCos(double x) {
+    return meshSin(x + MESH_PI / 2.0);
+}
+
+// Attaches per-vertex attributes: make(index, position) returns one vertex
+template <typename V, size_t N, typename F>
+constexpr std::array<V, N> buildVertices(const std::array<MeshPosition, N>& positions, F make) {
+    std::array<V, N> vertices{};
+    for (size_t i = 0; i < N; i++) {
+        vertices[i] = make(i, positions[i]);
+    }
+    return vertices;
+}
+
+// Unit cube centred on the origin, four vertices per face so faces stay flat
+
+constexpr std::array<MeshPosition, 24> makeCubePositions() {
+    constexpr float s = 0.5f;
+    return {{
+        // Front face
+        {-s, -s, s}, {s, -s, s}, {s, s, s}, {-s, s, s},
+        // Back face
+        {-s, -s, -s}, {-s, s, -s}, {s, s, -s}, {s, -s, -s},
+        // Top face
+        {-s, s, -s}, {-s, s, s}, {s, s, s}, {s, s, -s},
+        // Bottom face
+        {-s, -s, -s}, {s, -s, -s}, {s, -s, s}, {-s, -s, s},
+        // Right face
+        {s, -s, -s}, {s, s, -s}, {s, s, s}, {s, -s, s},
+        // Left face
+        {-s, -s, -s}, {-s, -s, s}, {-s, s, s}, {-s, s, -s}
+    }};
+}
+
+template <typename Index>
+constexpr std::array<Index, 36> makeCubeIndices() {
+    std::array<Index, 36> indices{};
+    for (int face = 0; face < 6; face++) {
+        Index k = static_cast<Index>(face * 4);
+        Index quad[6] = {k, Index(k + 1), Index(k + 2), Index(k + 2), Index(k + 3), k};
+        for (int i = 0; i < 6; i++) {
+            indices[face * 6 + i] = quad[i];
+        }
+    }
+    return indices;
+}
+
+// Unit sphere as a UV grid: Stacks + 1 rings of Sectors + 1 vertices from the
+// +z pole to the -z pole (the seam column is duplicated)
+
+template <int Sectors, int Stacks>
+constexpr std::array<MeshPosition, (Sectors + 1) * (Stacks + 1)> makeSpherePositions() {
+    std::array<MeshPosition, (Sectors + 1) * (Stacks + 1)> positions{};
+    size_t v = 0;
+    for (int i = 0; i <= Stacks; i++) {
+        double stackAngle = MESH_PI / 2.0 - i * MESH_PI / Stacks;
+        double xy = meshCos(stackAngle);
+        double z = meshSin(stackAngle);
+        for (int j = 0; j <= Sectors; j++) {
+            double sectorAngle = j * 2.0 * MESH_PI / Sectors;
+            positions[v++] = {float(xy * meshCos(sectorAngle)), float(xy * meshSin(sectorAngle)), float(z)};
+        }
+    }
+    return positions;
+}
+
+// The pole rings contribute one triangle per sector, every other ring two
+template <typename Index, int Sectors, int Stacks>
+constexpr std::array<Index, 6 * Sectors * (Stacks - 1)> makeSphereIndices() {
+    std::array<Index, 6 * Sectors * (Stacks - 1)> indices{};
+    size_t n = 0;
+    for (int i = 0; i < Stacks; i++) {
+        int k1 = i * (Sectors + 1);
+        int k2 = k1 + Sectors + 1;
+        for (int j = 0; j < Sectors; j++, k1++, k2++) {
+            if (i != 0) {
+                indices[n++] = Index(k1);
+                indices[n++] = Index(k2);
+                indices[n++] = Index(k1 + 1);
+            }
+            if (i != Stacks - 1) {
+                indices[n++] = Index(k1 + 1);
+                indices[n++] = Index(k2);
+                indices[n++] = Index(k2 + 1);
+            }
+        }
+    }
+    return indices;
+}
+
+// Pitch in the y = 0 plane: the grass quad, the boundary ellipse, the halfway
+// line and the centre circle. Lines sit slightly above the grass.
+
+constexpr int FIELD_LINE_SEGMENTS = 40;
+constexpr size_t FIELD_VERTEX_COUNT = 4 + FIELD_LINE_SEGMENTS + 2 + FIELD_LINE_SEGMENTS;
+constexpr size_t FIELD_INDEX_COUNT = 6 + 2 * FIELD_LINE_SEGMENTS + 2 + 2 * FIELD_LINE_SEGMENTS;
+constexpr size_t FIELD_GRASS_VERTEX_COUNT = 4;
+
+constexpr std::array<MeshPosition, FIELD_VERTEX_COUNT> makeFieldPositions(float halfWidth, float halfHeight,
+                                                                          float circleRadius) {
+    constexpr float lineHeight = 0.01f;
+    std::array<MeshPosition, FIELD_VERTEX_COUNT> positions{};
+    size_t v = 0;
+
+    positions[v++] = {-halfWidth, 0.0f, -halfHeight};
+    positions[v++] = {halfWidth, 0.0f, -halfHeight};
+    positions[v++] = {halfWidth, 0.0f, halfHeight};
+    positions[v++] = {-halfWidth, 0.0f, halfHeight};
+
+    for (int i = 0; i < FIELD_LINE_SEGMENTS; i++) {
+        double angle = i * 2.0 * MESH_PI / FIELD_LINE_SEGMENTS;
+        positions[v++] = {float(halfWidth * meshCos(angle)), lineHeight, float(halfHeight * meshSin(angle))};
+    }
+
+    positions[v++] = {0.0f, lineHeight, -halfHeight};
+    positions[v++] = {0.0f, lineHeight, halfHeight};
+
+    for (int i = 0; i < FIELD_LINE_SEGMENTS; i++) {
+        double angle = i * 2.0 * MESH_PI / FIELD_LINE_SEGMENTS;
+        positions[v++] = {float(circleRadius * meshCos(angle)), lineHeight, float(circleRadius * meshSin(angle))};
+    }
+    return positions;
+}
+
+template <typename Index>
+constexpr std::array<Index, FIELD_INDEX_COUNT> makeFieldIndices() {
+    std::array<Index, FIELD_INDEX_COUNT> indices{};
+    size_t n = 0;
+
+    // Grass quad
+    Index quad[6] = {0, 1, 2, 2, 3, 0};
+    for (Index i : quad) {
+        indices[n++] = i;
+    }
+
+    // Closed line loops for the boundary and the centre circle, halfway line
+    // in between
+    auto loop = [&](int first) {
+        for (int i = 0; i < FIELD_LINE_SEGMENTS; i++) {
+            indices[n++] = Index(first + i);
+            indices[n++] = Index(first + (i + 1) % FIELD_LINE_SEGMENTS);
+        }
+    };
+    loop(4);
+    indices[n++] = Index(4 + FIELD_LINE_SEGMENTS);
+    indices[n++] = Index(4 + FIELD_LINE_SEGMENTS + 1);
+    loop(4 + FIELD_LINE_SEGMENTS + 2);
+    return indices;
+}
+
+// Level-of-detail chains: several meshes packed into one vertex and one index
+// array, finest level first. Indices stay local to their level, so a level is
+// drawn with its firstIndex and vertexOffset.
+
+struct MeshRange {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    int32_t vertexOffset;
+};
+
+template <typename Index, size_t V, size_t I, size_t L>
+struct MeshLodChain {
+    std::array<MeshPosition, V> positions;
+    std::array<Index, I> indices;
+    std::array<MeshRange, L> levels;
+};
+
+// Unit spheres with Sectors x Sectors/2 quads per level
+template <typename Index, int... Sectors>
+constexpr auto makeSphereLodChain() {
+    constexpr size_t vertexCount = ((size_t(Sectors + 1) * (Sectors / 2 + 1)) + ...);
+    constexpr size_t indexCount = ((size_t(6) * Sectors * (Sectors / 2 - 1)) + ...);
+    MeshLodChain<Index, vertexCount, indexCount, sizeof...(Sectors)> chain{};
+    size_t v = 0;
+    size_t n = 0;
+    size_t level = 0;
+    auto append = [&](const auto& positions, const auto& indices) {
+        chain.levels[level++] = {uint32_t(n), uint32_t(indices.size()), int32_t(v)};
+        for (const MeshPosition& p : positions) {
+            chain.positions[v++] = p;
+        }
+        for (Index i : indices) {
+            chain.indices[n++] = i;
+        }
+    };
+    (append(makeSpherePositions<Sectors, Sectors / 2>(), makeSphereIndices<Index, Sectors, Sectors / 2>()), ...);
+    return chain;
+}
+
+// Fraction a projected size has to move past a level threshold before the
+// level changes, so an object hovering at a boundary does not pop every frame
+constexpr float MESH_LOD_HYSTERESIS = 0.15f;
+
+// minPixels[i] is the smallest projected diameter that still uses level i;
+// the last level should have 0. Steps from the current level so a switch
+// needs the size to clear the threshold by the hysteresis margin.
+inline int selectMeshLod(const float* minPixels, int levelCount, float diameterPixels, int current) {
+    int level = current < 0 ? levelCount - 1 : (current < levelCount ? current : levelCount - 1);
+    while (level > 0 && diameterPixels >= minPixels[level - 1] * (1.0f + MESH_LOD_HYSTERESIS)) {
+        level--;
+    }
+    while (level < levelCount - 1 && diameterPixels < minPixels[level] * (1.0f - MESH_LOD_HYSTERESIS)) {
+        level++;
+    }
+    return level;
+}
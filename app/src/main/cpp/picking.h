@@ -0,0 +1,35 @@
+#pragma once
+
+#include "simd_math.h"
+
+struct Ray {
+    Vec3 origin;
+    Vec3 direction;   // Normalized
+};
+
+// Ray from the camera through a window position (pixels, y down), given the
+// inverse of the view-projection the frame under the cursor was drawn with.
+// Vulkan conventions: clip y points down and depth runs 0 (near) to 1 (far).
+inline Ray screenRay(const Mat4& inverseViewProj, float x, float y, float width, float height) {
+    float ndcX = 2.0f * x / width - 1.0f;
+    float ndcY = 2.0f * y / height - 1.0f;
+    Vec4 nearPoint = mat4Transform(inverseViewProj, {ndcX, ndcY, 0.0f, 1.0f});
+    Vec4 farPoint = mat4Transform(inverseViewProj, {ndcX, ndcY, 1.0f, 1.0f});
+    Vec3 origin = {nearPoint.x / nearPoint.w, nearPoint.y / nearPoint.w, nearPoint.z / nearPoint.w};
+    Vec3 end = {farPoint.x / farPoint.w, farPoint.y / farPoint.w, farPoint.z / farPoint.w};
+    return {origin, normalize({end.x - origin.x, end.y - origin.y, end.z - origin.z})};
+}
+
+// Where the ray meets the horizontal plane at the given height; false if it
+// runs parallel to it or away from it
+inline bool intersectGround(const Ray& ray, float height, Vec3& hit) {
+    if (std::fabs(ray.direction.y) < 1.0e-6f) {
+        return false;
+    }
+    float t = (height - ray.origin.y) / ray.direction.y;
+    if (t < 0.0f) {
+        return false;
+    }
+    hit = {ray.origin.x + ray.direction.x * t, height, ray.origin.z + ray.direction.z * t};
+    return true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+// Pipelines specialised per set of shader specialization constant values.
+// The first request for a set of values creates its pipeline, later ones
+// reuse it, so each draw binds a shader compiled for exactly its features
+// (the driver folds the constants and drops the dead branches) instead of
+// one that branches on uniforms, and no pipeline copies are written by hand.
+//
+// Constants is a plain struct of 4-byte members (float, int32_t, uint32_t or
+// VkBool32); member N is constant_id N and the struct itself is the
+// specialization data. Lookup is a linear scan: a frame uses a handful of
+// variants.
+template <typename Constants>
+class PipelineVariantCache {
+    static_assert(std::is_trivially_copyable_v<Constants> && sizeof(Constants) % sizeof(uint32_t) == 0,
+                  "specialization constants must be a plain struct of 4-byte members");
+
+public:
+    // Creates the pipeline for one specialization; called on a cache miss
+    using Factory = std::function<VkPipeline(const VkSpecializationInfo&)>;
+
+    void create(VkDevice device, Factory factory) {
+        this->device = device;
+        this->factory = std::move(factory);
+        entries.resize(sizeof(Constants) / sizeof(uint32_t));
+        for (uint32_t i = 0; i < entries.size(); i++) {
+            entries[i].constantID = i;
+            entries[i].offset = i * sizeof(uint32_t);
+            entries[i].size = sizeof(uint32_t);
+        }
+    }
+
+    void destroy() {
+        for (VkPipeline pipeline : pipelines) {
+            vkDestroyPipeline(device, pipeline, nullptr);
+        }
+        keys.clear();
+        pipelines.clear();
+    }
+
+    VkPipeline get(const Constants& constants) {
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (std::memcmp(&keys[i], &constants, sizeof(Constants)) == 0) {
+                return pipelines[i];
+            }
+        }
+
+        VkSpecializationInfo specialization{};
+        specialization.mapEntryCount = static_cast<uint32_t>(entries.size());
+        specialization.pMapEntries = entries.data();
+        specialization.dataSize = sizeof(Constants);
+        specialization.pData = &constants;
+        VkPipeline pipeline = factory(specialization);
+
+        keys.push_back(constants);
+        pipelines.push_back(pipeline);
+        return pipeline;
+    }
+
+    size_t size() const { return pipelines.size(); }
+
+private:
+    VkDevice device = VK_NULL_HANDLE;
+    Factory factory;
+    std::vector<VkSpecializationMapEntry> entries;
+    std::vector<Constants> keys;
+    std::vector<VkPipeline> pipelines;
+};
@@ -0,0 +1,162 @@
+#include "planner.h"
+#include "job_system.h"
+
+#include <chrono>
+#include <cmath>
+
+const float ROLLOUT_CHASE_RADIUS = 6.0f;
+const float ROLLOUT_KICK_ANGLE_NOISE = 0.1f;   // Radians
+const float ROLLOUT_KICK_SPEED_NOISE = 0.1f;   // Fraction of kick speed
+const int ROLLOUT_DEADLINE_CHECK_STEPS = 15;
+
+static int64_t nowTicks() {
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+// xorshift32: cheap per-rollout randomness that needs no shared state
+static float nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (state & 0xFFFFFF) / float(0x1000000);
+}
+
+std::vector<PlannerCandidate> MonteCarloPlanner::kickFan(int team, int count, float speed) {
+    std::vector<PlannerCandidate> candidates(count);
+    float direction = attackDirection(team);
+    for (int i = 0; i < count; i++) {
+        // Spread over +/-60 degrees around straight up the pitch
+        float t = count > 1 ? (float)i / (count - 1) : 0.5f;
+        float angle = (t - 0.5f) * 2.0f * (float)M_PI / 3.0f;
+        candidates[i].kickVelocity = {sinf(angle) * speed, 0.0f, cosf(angle) * speed * direction};
+    }
+    return candidates;
+}
+
+int MonteCarloPlanner::plan(const MatchSnapshot& snapshot, int team, std::vector<PlannerCandidate>& candidates,
+                            float budgetMicros) {
+    if (candidates.empty()) {
+        return -1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto budget = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<float, std::micro>(budgetMicros));
+
+    // Each job rolls out until the deadline; a job that starts late finds
+    // it passed and returns at once
+    uint32_t jobCount = jobs.workerCount() + 1;
+    accumulators.resize(jobCount);
+    for (auto& accumulator : accumulators) {
+        accumulator.sum.assign(candidates.size(), 0.0);
+        accumulator.count.assign(candidates.size(), 0);
+    }
+
+    jobSnapshot = &snapshot;
+    jobCandidates = &candidates;
+    jobTeam = team;
+    jobDeadline = (start + budget).time_since_epoch().count();
+    nextRollout.store(0, std::memory_order_relaxed);
+    jobs.parallelFor(jobCount, 1, [this](uint32_t first, uint32_t last) {
+        for (uint32_t job = first; job < last; job++) {
+            runRollouts(accumulators[job]);
+        }
+    });
+
+    lastRollouts = 0;
+    int best = -1;
+    for (size_t c = 0; c < candidates.size(); c++) {
+        double sum = 0.0;
+        uint32_t count = 0;
+        for (const auto& accumulator : accumulators) {
+            sum += accumulator.sum[c];
+            count += accumulator.count[c];
+        }
+        candidates[c].rollouts = count;
+        candidates[c].score = count > 0 ? static_cast<float>(sum / count) : 0.0f;
+        lastRollouts += count;
+        if (count > 0 && (best < 0 || candidates[c].score > candidates[best].score)) {
+            best = static_cast<int>(c);
+        }
+    }
+
+    lastElapsedMicros = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return best;
+}
+
+void MonteCarloPlanner::runRollouts(Accumulator& accumulator) {
+    uint32_t candidateCount = static_cast<uint32_t>(jobCandidates->size());
+
+    while (nowTicks() < jobDeadline) {
+        // Round-robin over candidates keeps the sample counts balanced
+        uint32_t ticket = nextRollout.fetch_add(1, std::memory_order_relaxed);
+        uint32_t candidate = ticket % candidateCount;
+        float outcome;
+        if (!rollout(candidate, ticket * 2654435761u + 1u, outcome)) {
+            break;
+        }
+        accumulator.sum[candidate] += outcome;
+        accumulator.count[candidate]++;
+    }
+}
+
+bool MonteCarloPlanner::rollout(uint32_t candidate, uint32_t seed, float& outcome) const {
+    MatchSnapshot state = *jobSnapshot;
+    uint32_t rng = seed ? seed : 1u;
+    int team = jobTeam;
+
+    // Noisy execution of the candidate kick
+    Vec3 kick = (*jobCandidates)[candidate].kickVelocity;
+    float angle = (nextRandom(rng) - 0.5f) * 2.0f * ROLLOUT_KICK_ANGLE_NOISE;
+    float speed = 1.0f + (nextRandom(rng) - 0.5f) * 2.0f * ROLLOUT_KICK_SPEED_NOISE;
+    float c = cosf(angle), s = sinf(angle);
+    state.ball.velocity = {(kick.x * c - kick.z * s) * speed, kick.y * speed, (kick.x * s + kick.z * c) * speed};
+    state.ball.onGround = kick.y == 0.0f;
+
+    // Each team reacts with its own random urgency
+    float urgency[2] = {0.5f + 0.5f * nextRandom(rng), 0.5f + 0.5f * nextRandom(rng)};
+
+    int steps = static_cast<int>(horizonSeconds / stepSeconds);
+    StepEvents events;
+    for (int step = 0; step < steps; step++) {
+        if (step % ROLLOUT_DEADLINE_CHECK_STEPS == 0 && nowTicks() >= jobDeadline) {
+            return false;
+        }
+
+        // Reactive policy: players near the ball run at it, the rest hold
+        for (uint32_t i = 0; i < state.playerCount; i++) {
+            Player& player = state.players[i];
+            float dx = state.ball.position.x - player.position.x;
+            float dz = state.ball.position.z - player.position.z;
+            float distance = sqrtf(dx*dx + dz*dz);
+            if (distance < ROLLOUT_CHASE_RADIUS && distance > 0.1f) {
+                float v = PLAYER_SPEED * urgency[player.team] / distance;
+                player.velocity = {dx * v, 0.0f, dz * v};
+            } else {
+                player.velocity = {0.0f, 0.0f, 0.0f};
+            }
+        }
+
+        stepMatch(state, stepSeconds, &events);
+        if (events.goalSide != 0) {
+            outcome = events.goalSide == static_cast<int>(attackDirection(team)) ? 1.0f : -1.0f;
+            return true;
+        }
+    }
+
+    // No goal: reward field progress and being nearest to the ball
+    float progress = state.ball.position.z * attackDirection(team) / (FIELD_HEIGHT / 2);
+    float nearest = 1.0e9f;
+    int nearestTeam = team;
+    for (uint32_t i = 0; i < state.playerCount; i++) {
+        float dx = state.ball.position.x - state.players[i].position.x;
+        float dz = state.ball.position.z - state.players[i].position.z;
+        float d = dx*dx + dz*dz;
+        if (d < nearest) {
+            nearest = d;
+            nearestTeam = state.players[i].team;
+        }
+    }
+    outcome = progress * 0.5f + (nearestTeam == team ? 0.2f : -0.2f);
+    return true;
+}
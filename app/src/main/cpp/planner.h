@@ -0,0 +1,66 @@
+#pragma once
+
+#include "simulation.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+// One candidate action for the kicking team: the velocity given to the ball
+struct PlannerCandidate {
+    Vec3 kickVelocity;
+    float score = 0.0f;       // Mean rollout outcome, -1 (own goal) .. +1 (goal)
+    uint32_t rollouts = 0;
+};
+
+// Monte Carlo lookahead for set pieces and key decisions. Each rollout clones
+// the match snapshot, applies a candidate kick, and fast-forwards stepMatch
+// under a noisy reactive policy for the other players. Rollouts run as one
+// job per worker of the shared job system plus the calling thread, and stop
+// hard at the time budget.
+class MonteCarloPlanner {
+public:
+    explicit MonteCarloPlanner(JobSystem& jobs) : jobs(jobs) {}
+
+    MonteCarloPlanner(const MonteCarloPlanner&) = delete;
+    MonteCarloPlanner& operator=(const MonteCarloPlanner&) = delete;
+
+    // Scores every candidate from the snapshot and returns the best index,
+    // or -1 if no rollout finished inside the budget.
+    int plan(const MatchSnapshot& snapshot, int team, std::vector<PlannerCandidate>& candidates,
+             float budgetMicros);
+
+    // Evenly spread kicks toward the team's attacking half
+    static std::vector<PlannerCandidate> kickFan(int team, int count, float speed);
+
+    float horizonSeconds = 3.0f;
+    float stepSeconds = 1.0f / 60.0f;
+
+    // Stats from the last plan() call
+    uint64_t lastRollouts = 0;
+    float lastElapsedMicros = 0.0f;
+    float rolloutsPerSecond() const {
+        return lastElapsedMicros > 0.0f ? lastRollouts * 1.0e6f / lastElapsedMicros : 0.0f;
+    }
+
+private:
+    struct Accumulator {
+        std::vector<double> sum;
+        std::vector<uint32_t> count;
+    };
+
+    void runRollouts(Accumulator& accumulator);
+    bool rollout(uint32_t candidate, uint32_t seed, float& outcome) const;
+
+    JobSystem& jobs;
+    std::vector<Accumulator> accumulators;   // One per rollout job
+
+    // Current plan, read-only while rollouts run
+    const MatchSnapshot* jobSnapshot = nullptr;
+    const std::vector<PlannerCandidate>* jobCandidates = nullptr;
+    int jobTeam = 0;
+    int64_t jobDeadline = 0;      // steady_clock ticks
+    std::atomic<uint32_t> nextRollout{0};
+};
@@ -0,0 +1,206 @@
+#include "player_ai.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+void PlayerAI::init(const std::string& treePath, const std::vector<Player>& players) {
+    registry = BtRegistry();
+    registry.add("isUserControlled", isUserControlled);
+    registry.add("isClosestToBall", isClosestToBall);
+    registry.add("isBallNear", isBallNear);
+    registry.add("idle", idle);
+    registry.add("chaseBall", chaseBall);
+    registry.add("supportBall", supportBall);
+    registry.add("holdPosition", holdPosition);
+
+    tree = BehaviorTree::compileFile(treePath, registry);
+
+    uint32_t count = static_cast<uint32_t>(players.size());
+    blackboard.resize(count, BB_SLOT_COUNT);
+    context.blackboard = &blackboard;
+    context.user = this;
+    context.reserve(count, tree.maxDepth());
+
+    scheduler.resize(count);
+    context.depthLimit = scheduler.depthLimits();
+    tick = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        setHomePosition(i, players[i].position.x, players[i].position.z);
+    }
+}
+
+void PlayerAI::setHomePosition(size_t player, float x, float z) {
+    blackboard.slot(BB_HOME_X)[player] = x;
+    blackboard.slot(BB_HOME_Z)[player] = z;
+}
+
+void PlayerAI::update(std::vector<Player>& players, const Ball& ball, const Frustum& frustum,
+                      const PredictionCache& prediction) {
+    uint32_t count = static_cast<uint32_t>(players.size());
+    ballPosition = ball.position;
+    this->prediction = &prediction;
+
+    float* posX = blackboard.slot(BB_POS_X);
+    float* posZ = blackboard.slot(BB_POS_Z);
+    float* ballDist = blackboard.slot(BB_BALL_DIST);
+    float* closest = blackboard.slot(BB_CLOSEST_TO_BALL);
+    float* controlled = blackboard.slot(BB_USER_CONTROLLED);
+
+    // Gather inputs and find the closest player to the ball on each team
+    float bestDist[2] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+    int bestPlayer[2] = {-1, -1};
+    for (uint32_t i = 0; i < count; i++) {
+        const Player& player = players[i];
+        posX[i] = player.position.x;
+        posZ[i] = player.position.z;
+        float dx = ball.position.x - player.position.x;
+        float dz = ball.position.z - player.position.z;
+        ballDist[i] = sqrtf(dx*dx + dz*dz);
+        controlled[i] = player.selected ? 1.0f : 0.0f;
+        closest[i] = 0.0f;
+
+        if (!player.selected && ballDist[i] < bestDist[player.team]) {
+            bestDist[player.team] = ballDist[i];
+            bestPlayer[player.team] = static_cast<int>(i);
+        }
+    }
+    for (int team = 0; team < 2; team++) {
+        if (bestPlayer[team] >= 0) {
+            closest[bestPlayer[team]] = 1.0f;
+        }
+    }
+
+    // Decide for the due players, most overdue first, until the budget is spent
+    auto start = std::chrono::steady_clock::now();
+    scheduler.schedule(players, ball, frustum, tick);
+    const std::vector<uint16_t>& due = scheduler.due();
+    uint32_t dueCount = static_cast<uint32_t>(due.size());
+    uint32_t done = 0;
+    float spent = 0.0f;
+    while (done < dueCount) {
+        uint32_t chunk = std::min(AI_BUDGET_CHUNK, dueCount - done);
+        tree.evaluate(context, due.data() + done, chunk);
+        for (uint32_t i = done; i < done + chunk; i++) {
+            scheduler.markUpdated(due[i], tick);
+        }
+        done += chunk;
+
+        spent = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+        if (spent >= scheduler.budgetMicros) {
+            break;
+        }
+    }
+    scheduler.updatedCount = done;
+    scheduler.deferredCount = dueCount - done;
+    scheduler.spentMicros = spent;
+    tick++;
+
+    // Turn targets into velocities; the physics step integrates them
+    const float* targetX = blackboard.slot(BB_TARGET_X);
+    const float* targetZ = blackboard.slot(BB_TARGET_Z);
+    const float* targetSpeed = blackboard.slot(BB_TARGET_SPEED);
+    for (uint32_t i = 0; i < count; i++) {
+        Player& player = players[i];
+        float dx = targetX[i] - posX[i];
+        float dz = targetZ[i] - posZ[i];
+        float length = sqrtf(dx*dx + dz*dz);
+        if (length > 0.1f && targetSpeed[i] > 0.0f) {
+            float speed = PLAYER_SPEED * targetSpeed[i] / length;
+            player.velocity.x = dx * speed;
+            player.velocity.z = dz * speed;
+        } else {
+            player.velocity.x = 0.0f;
+            player.velocity.z = 0.0f;
+        }
+    }
+}
+
+void PlayerAI::isUserControlled(void*, Blackboard& bb, const uint16_t* agents, uint32_t count, uint8_t* status) {
+    const float* controlled = bb.slot(BB_USER_CONTROLLED);
+    for (uint32_t i = 0; i < count; i++) {
+        status[agents[i]] = controlled[agents[i]] != 0.0f ? BT_SUCCESS : BT_FAILURE;
+    }
+}
+
+void PlayerAI::isClosestToBall(void*, Blackboard& bb, const uint16_t* agents, uint32_t count, uint8_t* status) {
+    const float* closest = bb.slot(BB_CLOSEST_TO_BALL);
+    for (uint32_t i = 0; i < count; i++) {
+        status[agents[i]] = closest[agents[i]] != 0.0f ? BT_SUCCESS : BT_FAILURE;
+    }
+}
+
+void PlayerAI::isBallNear(void*, Blackboard& bb, const uint16_t* agents, uint32_t count, uint8_t* status) {
+    const float* ballDist = bb.slot(BB_BALL_DIST);
+    for (uint32_t i = 0; i < count; i++) {
+        status[agents[i]] = ballDist[agents[i]] < BALL_NEAR_DISTANCE ? BT_SUCCESS : BT_FAILURE;
+    }
+}
+
+void PlayerAI::idle(void*, Blackboard& bb, const uint16_t* agents, uint32_t count, uint8_t* status) {
+    const float* posX = bb.slot(BB_POS_X);
+    const float* posZ = bb.slot(BB_POS_Z);
+    float* targetX = bb.slot(BB_TARGET_X);
+    float* targetZ = bb.slot(BB_TARGET_Z);
+    float* targetSpeed = bb.slot(BB_TARGET_SPEED);
+    for (uint32_t i = 0; i < count; i++) {
+        uint16_t a = agents[i];
+        targetX[a] = posX[a];
+        targetZ[a] = posZ[a];
+        targetSpeed[a] = 0.0f;
+        status[a] = BT_SUCCESS;
+    }
+}
+
+void PlayerAI::chaseBall(void* user, Blackboard& bb, const uint16_t* agents, uint32_t count, uint8_t* status) {
+    // Run to where the ball can be intercepted, not where it is now
+    const PredictionCache& prediction = *static_cast<PlayerAI*>(user)->prediction;
+    const float* posX = bb.slot(BB_POS_X);
+    const float* posZ = bb.slot(BB_POS_Z);
+    float* targetX = bb.slot(BB_TARGET_X);
+    float* targetZ = bb.slot(BB_TARGET_Z);
+    float* targetSpeed = bb.slot(BB_TARGET_SPEED);
+    for (uint32_t i = 0; i < count; i++) {
+        uint16_t a = agents[i];
+        Vec3 intercept;
+        prediction.interceptTime({posX[a], 0.0f, posZ[a]}, PLAYER_SPEED, intercept);
+        targetX[a] = intercept.x;
+        targetZ[a] = intercept.z;
+        targetSpeed[a] = 1.0f;
+        status[a] = BT_RUNNING;
+    }
+}
+
+void PlayerAI::supportBall(void* user, Blackboard& bb, const uint16_t* agents, uint32_t count, uint8_t* status) {
+    // Drift halfway from the home position toward the ball
+    const Vec3& ball = static_cast<PlayerAI*>(user)->ballPosition;
+    const float* homeX = bb.slot(BB_HOME_X);
+    const float* homeZ = bb.slot(BB_HOME_Z);
+    float* targetX = bb.slot(BB_TARGET_X);
+    float* targetZ = bb.slot(BB_TARGET_Z);
+    float* targetSpeed = bb.slot(BB_TARGET_SPEED);
+    for (uint32_t i = 0; i < count; i++) {
+        uint16_t a = agents[i];
+        targetX[a] = (homeX[a] + ball.x) * 0.5f;
+        targetZ[a] = (homeZ[a] + ball.z) * 0.5f;
+        targetSpeed[a] = 0.75f;
+        status[a] = BT_RUNNING;
+    }
+}
+
+void PlayerAI::holdPosition(void*, Blackboard& bb, const uint16_t* agents, uint32_t count, uint8_t* status) {
+    const float* homeX = bb.slot(BB_HOME_X);
+    const float* homeZ = bb.slot(BB_HOME_Z);
+    float* targetX = bb.slot(BB_TARGET_X);
+    float* targetZ = bb.slot(BB_TARGET_Z);
+    float* targetSpeed = bb.slot(BB_TARGET_SPEED);
+    for (uint32_t i = 0; i < count; i++) {
+        uint16_t a = agents[i];
+        targetX[a] = homeX[a];
+        targetZ[a] = homeZ[a];
+        targetSpeed[a] = 0.5f;
+        status[a] = BT_SUCCESS;
+    }
+}
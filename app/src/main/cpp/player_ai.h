@@ -0,0 +1,61 @@
+#pragma once
+
+#include "ai_lod.h"
+#include "behavior_tree.h"
+#include "prediction.h"
+#include "simulation.h"
+
+#include <string>
+#include <vector>
+
+// Blackboard slots shared by every player tree
+enum BlackboardSlot : uint32_t {
+    BB_POS_X,
+    BB_POS_Z,
+    BB_HOME_X,
+    BB_HOME_Z,
+    BB_BALL_DIST,
+    BB_CLOSEST_TO_BALL,
+    BB_USER_CONTROLLED,
+    BB_TARGET_X,
+    BB_TARGET_Z,
+    BB_TARGET_SPEED,   // Fraction of PLAYER_SPEED
+    BB_SLOT_COUNT
+};
+
+const float BALL_NEAR_DISTANCE = 4.0f;
+const uint32_t AI_BUDGET_CHUNK = 8;   // Players evaluated between budget checks
+
+// Drives every player from one compiled behavior tree. Inputs are gathered
+// into the blackboard once per tick, the tree is evaluated for all players in
+// a single batch, and the resulting targets become player velocities.
+// Only the players the LOD scheduler marks as due are re-evaluated, in
+// priority order, until the scheduler's time budget is spent.
+class PlayerAI {
+public:
+    void init(const std::string& treePath, const std::vector<Player>& players);
+    void update(std::vector<Player>& players, const Ball& ball, const Frustum& frustum,
+                const PredictionCache& prediction);
+
+    void setHomePosition(size_t player, float x, float z);
+
+    AiLodScheduler& lod() { return scheduler; }
+
+private:
+    static void isUserControlled(void* user, Blackboard& bb, const uint16_t* agents, uint32_t count, uint8_t* status);
+    static void isClosestToBall(void* user, Blackboard& bb, const uint16_t* agents, uint32_t count, uint8_t* status);
+    static void isBallNear(void* user, Blackboard& bb, const uint16_t* agents, uint32_t count, uint8_t* status);
+    static void idle(void* user, Blackboard& bb, const uint16_t* agents, uint32_t count, uint8_t* status);
+    static void chaseBall(void* user, Blackboard& bb, const uint16_t* agents, uint32_t count, uint8_t* status);
+    static void supportBall(void* user, Blackboard& bb, const uint16_t* agents, uint32_t count, uint8_t* status);
+    static void holdPosition(void* user, Blackboard& bb, const uint16_t* agents, uint32_t count, uint8_t* status);
+
+    BtRegistry registry;
+    BehaviorTree tree;
+    Blackboard blackboard;
+    BtContext context;
+    AiLodScheduler scheduler;
+    uint64_t tick = 0;
+    Vec3 ballPosition = {0.0f, 0.0f, 0.0f};
+    const PredictionCache* prediction = nullptr;
+};
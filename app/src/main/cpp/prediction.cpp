@@ -0,0 +1,88 @@
+#include "prediction.h"
+
+#include <algorithm>
+#include <cmath>
+
+void PredictionCache::update(const Player* players, size_t count, const Ball& ball, float dt) {
+    playerCount = static_cast<uint32_t>(count);
+    ballX.resize(PREDICTION_SAMPLES);
+    ballY.resize(PREDICTION_SAMPLES);
+    ballZ.resize(PREDICTION_SAMPLES);
+    playerX.resize(static_cast<size_t>(PREDICTION_SAMPLES) * count);
+    playerZ.resize(static_cast<size_t>(PREDICTION_SAMPLES) * count);
+
+    // Step the ball at the simulation step (friction is applied per step), and
+    // record every stride-th state. Short catch-up steps would multiply the
+    // step count, so they are clamped to the nominal rate
+    dt = std::max(dt, PREDICTION_MIN_STEP);
+    uint32_t stride = std::max(1u, static_cast<uint32_t>(PREDICTION_HORIZON / (PREDICTION_SAMPLES - 1) / dt + 0.5f));
+    interval = stride * dt;
+
+    Ball future = ball;
+    goalSide = 0;
+    goalTime = 0.0f;
+    for (uint32_t s = 0; s < PREDICTION_SAMPLES; s++) {
+        if (s > 0) {
+            for (uint32_t k = 0; k < stride; k++) {
+                StepEvents events;
+                stepBall(future, dt, &events);
+                if (events.goalSide != 0 && goalSide == 0) {
+                    goalSide = events.goalSide;
+                    goalTime = ((s - 1) * stride + k + 1) * dt;
+                }
+            }
+        }
+        ballX[s] = future.position.x;
+        ballY[s] = future.position.y;
+        ballZ[s] = future.position.z;
+    }
+
+    // Players keep their current velocity
+    const float limitX = FIELD_WIDTH/2 - PLAYER_SIZE;
+    const float limitZ = FIELD_HEIGHT/2 - PLAYER_SIZE;
+    for (uint32_t s = 0; s < PREDICTION_SAMPLES; s++) {
+        float t = s * interval;
+        float* rowX = playerX.data() + static_cast<size_t>(s) * count;
+        float* rowZ = playerZ.data() + static_cast<size_t>(s) * count;
+        for (size_t i = 0; i < count; i++) {
+            rowX[i] = std::clamp(players[i].position.x + players[i].velocity.x * t, -limitX, limitX);
+            rowZ[i] = std::clamp(players[i].position.z + players[i].velocity.z * t, -limitZ, limitZ);
+        }
+    }
+}
+
+Vec3 PredictionCache::ballAt(float t) const {
+    float f = std::clamp(t / interval, 0.0f, static_cast<float>(PREDICTION_SAMPLES - 1));
+    uint32_t s = std::min(static_cast<uint32_t>(f), PREDICTION_SAMPLES - 2);
+    float w = f - s;
+    return {
+        ballX[s] + (ballX[s + 1] - ballX[s]) * w,
+        ballY[s] + (ballY[s + 1] - ballY[s]) * w,
+        ballZ[s] + (ballZ[s + 1] - ballZ[s]) * w
+    };
+}
+
+Vec2 PredictionCache::playerAt(size_t player, float t) const {
+    float f = std::clamp(t / interval, 0.0f, static_cast<float>(PREDICTION_SAMPLES - 1));
+    uint32_t s = std::min(static_cast<uint32_t>(f), PREDICTION_SAMPLES - 2);
+    float w = f - s;
+    size_t a = static_cast<size_t>(s) * playerCount + player;
+    size_t b = a + playerCount;
+    return {playerX[a] + (playerX[b] - playerX[a]) * w, playerZ[a] + (playerZ[b] - playerZ[a]) * w};
+}
+
+float PredictionCache::interceptTime(const Vec3& from, float speed, Vec3& point) const {
+    for (uint32_t s = 0; s < PREDICTION_SAMPLES; s++) {
+        float t = s * interval;
+        float dx = ballX[s] - from.x;
+        float dz = ballZ[s] - from.z;
+        float reach = speed * t + PLAYER_SIZE;
+        if (dx*dx + dz*dz <= reach * reach) {
+            point = {ballX[s], ballY[s], ballZ[s]};
+            return t;
+        }
+    }
+    uint32_t last = PREDICTION_SAMPLES - 1;
+    point = {ballX[last], ballY[last], ballZ[last]};
+    return last * interval;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "simulation.h"
+
+#include <cstdint>
+#include <vector>
+
+const float PREDICTION_HORIZON = 2.0f;       // Seconds
+const uint32_t PREDICTION_SAMPLES = 64;      // Stored samples over the horizon
+const float PREDICTION_MIN_STEP = 1.0f / 120.0f;  // Shortest ball step, the nominal sim rate
+
+// Futures of the ball and players, integrated once per tick and shared by
+// every AI query. The ball runs through stepBall at the simulation's own
+// time step, so gravity, bounces, the goal reset and the per-step friction
+// match the real thing; only player contacts are ignored. Steps shorter than
+// PREDICTION_MIN_STEP (a catch-up tick) are stretched to it, which bounds
+// the work to HORIZON / MIN_STEP ball steps per update. Players are
+// extrapolated along their current velocity and clamped to the pitch.
+// Samples are stored time-major in flat arrays.
+class PredictionCache {
+public:
+    void update(const Player* players, size_t count, const Ball& ball, float dt);
+
+    float sampleInterval() const { return interval; }
+    uint32_t sampleCount() const { return PREDICTION_SAMPLES; }
+
+    // Linear interpolation between samples, clamped to the horizon
+    Vec3 ballAt(float t) const;
+    Vec2 playerAt(size_t player, float t) const;
+
+    // Earliest sample where a runner starting at `from` reaches the ball;
+    // falls back to the ball at the end of the horizon
+    float interceptTime(const Vec3& from, float speed, Vec3& point) const;
+
+    // First predicted goal (+1/-1, 0 if none) and its time
+    int goalSide = 0;
+    float goalTime = 0.0f;
+
+private:
+    float interval = PREDICTION_HORIZON / (PREDICTION_SAMPLES - 1);
+    uint32_t playerCount = 0;
+    std::vector<float> ballX, ballY, ballZ;           // [sample]
+    std::vector<float> playerX, playerZ;              // [sample * playerCount + player]
+};
@@ -0,0 +1,20 @@
+# Writes a SPIR-V module as comma-separated 32-bit words for #include into a
+# uint32_t array:
+#
+#     cmake -DINPUT=<module> -DOUTPUT=<file> -P embed_spirv.cmake
+
+file(READ ${INPUT} hex HEX)
+string(LENGTH "${hex}" length)
+math(EXPR remainder "${length} % 8")
+
+# The magic number 0x07230203, stored little endian
+if(length EQUAL 0 OR NOT remainder EQUAL 0 OR NOT hex MATCHES "^03022307")
+    message(FATAL_ERROR "${INPUT} is not a little-endian SPIR-V module")
+endif()
+
+# Eight words per line; the bytes of each word are reversed into a literal
+string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1, " words "${hex}")
+# (CMake regular expressions have no {n} repetition)
+string(REPEAT "0x........, " 8 line)
+string(REGEX REPLACE "(${line})" "\\1\n" words "${words}")
+file(WRITE ${OUTPUT} "${words}\n")
@@ -0,0 +1,29 @@
+#version 450
+
+// Specialization constants, see SceneSpecialization in engine_core.cpp. The
+// pipeline variant for each draw fixes them, so the branches below are
+// resolved when the pipeline is created.
+layout(constant_id = 0) const float TEAM_R = -1.0;   // Negative: use the vertex colour
+layout(constant_id = 1) const float TEAM_G = 0.0;
+layout(constant_id = 2) const float TEAM_B = 0.0;
+layout(constant_id = 3) const uint LOD = 0;
+layout(constant_id = 4) const uint DEBUG_VIEW = 0;
+
+const uint DEBUG_VIEW_LOD = 1;   // Tint meshes by level of detail, finest green
+const vec3 LOD_COLORS[4] = vec3[](vec3(0.0, 1.0, 0.0), vec3(1.0, 1.0, 0.0),
+                                  vec3(1.0, 0.5, 0.0), vec3(1.0, 0.0, 0.0));
+
+layout(location = 0) in vec4 fragColor;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    vec4 color = fragColor;
+    if (TEAM_R >= 0.0) {
+        color.rgb = vec3(TEAM_R, TEAM_G, TEAM_B);
+    }
+    if (DEBUG_VIEW == DEBUG_VIEW_LOD) {
+        color.rgb = mix(color.rgb, LOD_COLORS[min(LOD, 3u)], 0.75);
+    }
+    outColor = color;
+}
@@ -0,0 +1,52 @@
+#version 450
+
+// Scene geometry. The default variant takes the camera from the uniform
+// buffer and the model matrix from a push constant; the INSTANCED variant
+// draws the instances the cull pass left in the visible list, with the
+// camera in a push constant.
+
+#ifdef INSTANCED
+struct Instance {
+    mat4 model;
+    vec4 color;
+    vec4 sphere;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Instances {
+    Instance instances[];
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer Visible {
+    uint visible[];
+};
+
+layout(push_constant) uniform Camera {
+    mat4 viewProj;
+} camera;
+#else
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+layout(push_constant) uniform Object {
+    mat4 model;
+} object;
+#endif
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec4 inColor;
+
+layout(location = 0) out vec4 fragColor;
+
+void main() {
+#ifdef INSTANCED
+    Instance instance = instances[visible[gl_InstanceIndex]];
+    gl_Position = camera.viewProj * instance.model * vec4(inPosition, 1.0);
+    fragColor = instance.color;
+#else
+    gl_Position = ubo.proj * ubo.view * object.model * vec4(inPosition, 1.0);
+    fragColor = inColor;
+#endif
+}
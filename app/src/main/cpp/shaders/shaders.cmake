@@ -0,0 +1,103 @@
+# Build-time shader compilation. Each variant is a GLSL source compiled with
+# a set of defines (so the plain and instanced paths share one source), run
+# through spirv-opt, and written as a comma-separated list of uint32_t words
+# that C++ embeds directly:
+#
+#     static constexpr uint32_t code[] = {
+#         #include "vert.spv"
+#     };
+#
+# With SHADER_DEBUG the modules keep their debug info, skip spirv-opt and are
+# compiled with DEBUG defined, for stepping through them in RenderDoc.
+
+option(SHADER_DEBUG "Build shaders with debug info and without spirv-opt" OFF)
+
+# The NDK ships glslc and spirv-opt; on the host they come with the Vulkan SDK
+set(SHADER_TOOL_HINTS)
+if(ANDROID_NDK AND ANDROID_HOST_TAG)
+    list(APPEND SHADER_TOOL_HINTS ${ANDROID_NDK}/shader-tools/${ANDROID_HOST_TAG})
+endif()
+if(DEFINED ENV{VULKAN_SDK})
+    list(APPEND SHADER_TOOL_HINTS $ENV{VULKAN_SDK}/bin)
+endif()
+
+find_program(GLSLC glslc HINTS ${SHADER_TOOL_HINTS})
+find_program(GLSLANG_VALIDATOR glslangValidator HINTS ${SHADER_TOOL_HINTS})
+find_program(SPIRV_OPT spirv-opt HINTS ${SHADER_TOOL_HINTS})
+
+if(NOT GLSLC AND NOT GLSLANG_VALIDATOR)
+    message(FATAL_ERROR "Building shaders needs glslc or glslangValidator (NDK shader-tools or the Vulkan SDK)")
+endif()
+if(NOT SPIRV_OPT AND NOT SHADER_DEBUG)
+    message(WARNING "spirv-opt not found, shaders are embedded unoptimised")
+endif()
+
+set(SHADER_SOURCE_DIR ${CMAKE_CURRENT_LIST_DIR})
+set(SHADER_OUTPUT_DIR ${CMAKE_CURRENT_BINARY_DIR}/shaders)
+file(MAKE_DIRECTORY ${SHADER_OUTPUT_DIR})
+
+# add_shader_variant(<output> <source> [<define>...])
+#
+# Compiles shaders/<source> with -D<define> for each define into <output>,
+# which is #included from the C++ code. The stage comes from the source's
+# extension (.vert, .frag, .comp).
+function(add_shader_variant output source)
+    set(input ${SHADER_SOURCE_DIR}/${source})
+    set(module ${SHADER_OUTPUT_DIR}/${output}.bin)
+    set(depfile ${module}.d)
+
+    set(defines)
+    foreach(define ${ARGN})
+        list(APPEND defines -D${define})
+    endforeach()
+    if(SHADER_DEBUG)
+        list(APPEND defines -DDEBUG)
+    endif()
+
+    # Compile without optimisation: spirv-opt does that below, so the
+    # result is the same whichever front end is installed
+    if(GLSLC)
+        set(compile ${GLSLC} --target-env=vulkan1.0 -O0 ${defines} -MD -MF ${depfile} -o ${module} ${input})
+    else()
+        set(compile ${GLSLANG_VALIDATOR} -V --target-env vulkan1.0 ${defines} --depfile ${depfile} -o ${module} ${input})
+    endif()
+    if(SHADER_DEBUG)
+        list(APPEND compile -g)
+    endif()
+
+    add_custom_command(
+        OUTPUT ${module}
+        COMMAND ${compile}
+        DEPENDS ${input}
+        DEPFILE ${depfile}
+        COMMENT "Compiling shader ${source} -> ${output}"
+        VERBATIM)
+
+    # Performance passes, and the names and source text stripped for size
+    set(embedded ${module})
+    set(optimize)
+    if(SPIRV_OPT AND NOT SHADER_DEBUG)
+        set(embedded ${module}.opt)
+        set(optimize COMMAND ${SPIRV_OPT} -O --strip-debug ${module} -o ${embedded})
+    endif()
+
+    add_custom_command(
+        OUTPUT ${SHADER_OUTPUT_DIR}/${output}
+        ${optimize}
+        COMMAND ${CMAKE_COMMAND} -DINPUT=${embedded} -DOUTPUT=${SHADER_OUTPUT_DIR}/${output}
+                -P ${SHADER_SOURCE_DIR}/embed_spirv.cmake
+        DEPENDS ${module} ${SHADER_SOURCE_DIR}/embed_spirv.cmake
+        COMMENT "Embedding shader ${output}"
+        VERBATIM)
+
+    set_property(GLOBAL APPEND PROPERTY SHADER_VARIANT_OUTPUTS ${SHADER_OUTPUT_DIR}/${output})
+endfunction()
+
+# Builds every variant added so far before <target> and puts them on its
+# include path
+function(target_embed_shaders target)
+    get_property(outputs GLOBAL PROPERTY SHADER_VARIANT_OUTPUTS)
+    add_custom_target(${target}-shaders DEPENDS ${outputs})
+    add_dependencies(${target} ${target}-shaders)
+    target_include_directories(${target} PRIVATE ${SHADER_OUTPUT_DIR})
+endfunction()
@@ -0,0 +1,302 @@
+#pragma once
+
+// Header-only vector/matrix math shared by the simulation and renderers.
+//
+// Matrices are column-major (m[12..14] is the translation) and compose like
+// GLSL: mat4Multiply(a, b) is a * b, so a point is transformed by b first.
+// Mat4 work uses SSE on x86, NEON on ARM, and a scalar fallback elsewhere or
+// when SIMD_MATH_FORCE_SCALAR is defined.
+
+#include <cmath>
+#include <cstddef>
+
+#if !defined(SIMD_MATH_FORCE_SCALAR) && (defined(__SSE__) || defined(_M_X64) || defined(_M_IX86))
+#define SIMD_MATH_SSE 1
+#include <xmmintrin.h>
+#elif !defined(SIMD_MATH_FORCE_SCALAR) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define SIMD_MATH_NEON 1
+#include <arm_neon.h>
+#else
+#define SIMD_MATH_SCALAR 1
+#endif
+
+struct Vec2 { float x, y; };
+struct Vec3 { float x, y, z; };
+struct alignas(16) Vec4 { float x, y, z, w; };
+struct alignas(16) Mat4 { float m[16]; };
+
+#if SIMD_MATH_SSE
+inline const char* simdMathBackend() { return "sse"; }
+#elif SIMD_MATH_NEON
+inline const char* simdMathBackend() { return "neon"; }
+#else
+inline const char* simdMathBackend() { return "scalar"; }
+#endif
+
+inline float radians(float degrees) {
+    return degrees * 0.01745329251994329577f;
+}
+
+// Vec3 helpers
+
+inline float dot(const Vec3& a, const Vec3& b) {
+    return a.x*b.x + a.y*b.y + a.z*b.z;
+}
+
+inline Vec3 cross(const Vec3& a, const Vec3& b) {
+    return {
+        a.y*b.z - a.z*b.y,
+        a.z*b.x - a.x*b.z,
+        a.x*b.y - a.y*b.x
+    };
+}
+
+inline float length(const Vec3& v) {
+    return std::sqrt(dot(v, v));
+}
+
+// Zero-length vectors come back unchanged instead of dividing by zero
+inline Vec3 normalize(const Vec3& v) {
+    float len = length(v);
+    if (len <= 1.0e-12f) {
+        return v;
+    }
+    float inv = 1.0f / len;
+    return {v.x * inv, v.y * inv, v.z * inv};
+}
+
+// Mat4 construction
+
+inline Mat4 mat4Identity() {
+    return {{
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f
+    }};
+}
+
+inline Mat4 mat4Translate(float x, float y, float z) {
+    Mat4 mat = mat4Identity();
+    mat.m[12] = x;
+    mat.m[13] = y;
+    mat.m[14] = z;
+    return mat;
+}
+
+inline Mat4 mat4Scale(float x, float y, float z) {
+    Mat4 mat = {};
+    mat.m[0] = x;
+    mat.m[5] = y;
+    mat.m[10] = z;
+    mat.m[15] = 1.0f;
+    return mat;
+}
+
+// Right-handed perspective with Vulkan's 0..1 depth range
+inline Mat4 mat4Perspective(float fov, float aspect, float near, float far) {
+    Mat4 mat = {};
+    float f = 1.0f / std::tan(fov * 0.5f);
+    mat.m[0] = f / aspect;
+    mat.m[5] = f;
+    mat.m[10] = far / (near - far);
+    mat.m[11] = -1.0f;
+    mat.m[14] = (far * near) / (near - far);
+    return mat;
+}
+
+inline Mat4 mat4LookAt(const Vec3& eye, const Vec3& center, const Vec3& up) {
+    Mat4 mat = {};
+    Vec3 f = normalize({center.x - eye.x, center.y - eye.y, center.z - eye.z});
+    Vec3 s = normalize(cross(f, up));
+    Vec3 u = cross(s, f);
+
+    mat.m[0] = s.x;
+    mat.m[1] = u.x;
+    mat.m[2] = -f.x;
+    mat.m[4] = s.y;
+    mat.m[5] = u.y;
+    mat.m[6] = -f.y;
+    mat.m[8] = s.z;
+    mat.m[9] = u.z;
+    mat.m[10] = -f.z;
+    mat.m[12] = -dot(s, eye);
+    mat.m[13] = -dot(u, eye);
+    mat.m[14] = dot(f, eye);
+    mat.m[15] = 1.0f;
+    return mat;
+}
+
+// Mat4 products
+
+inline Mat4 mat4Multiply(const Mat4& a, const Mat4& b) {
+    Mat4 r;
+#if SIMD_MATH_SSE
+    __m128 a0 = _mm_load_ps(a.m);
+    __m128 a1 = _mm_load_ps(a.m + 4);
+    __m128 a2 = _mm_load_ps(a.m + 8);
+    __m128 a3 = _mm_load_ps(a.m + 12);
+    for (int j = 0; j < 4; j++) {
+        const float* col = b.m + j * 4;
+        __m128 v = _mm_mul_ps(a0, _mm_set1_ps(col[0]));
+        v = _mm_add_ps(v, _mm_mul_ps(a1, _mm_set1_ps(col[1])));
+        v = _mm_add_ps(v, _mm_mul_ps(a2, _mm_set1_ps(col[2])));
+        v = _mm_add_ps(v, _mm_mul_ps(a3, _mm_set1_ps(col[3])));
+        _mm_store_ps(r.m + j * 4, v);
+    }
+#elif SIMD_MATH_NEON
+    float32x4_t a0 = vld1q_f32(a.m);
+    float32x4_t a1 = vld1q_f32(a.m + 4);
+    float32x4_t a2 = vld1q_f32(a.m + 8);
+    float32x4_t a3 = vld1q_f32(a.m + 12);
+    for (int j = 0; j < 4; j++) {
+        const float* col = b.m + j * 4;
+        float32x4_t v = vmulq_n_f32(a0, col[0]);
+        v = vmlaq_n_f32(v, a1, col[1]);
+        v = vmlaq_n_f32(v, a2, col[2]);
+        v = vmlaq_n_f32(v, a3, col[3]);
+        vst1q_f32(r.m + j * 4, v);
+    }
+#else
+    for (int j = 0; j < 4; j++) {
+        for (int i = 0; i < 4; i++) {
+            r.m[j*4 + i] = a.m[i] * b.m[j*4] + a.m[4 + i] * b.m[j*4 + 1] +
+                           a.m[8 + i] * b.m[j*4 + 2] + a.m[12 + i] * b.m[j*4 + 3];
+        }
+    }
+#endif
+    return r;
+}
+
+inline Vec4 mat4Transform(const Mat4& a, const Vec4& v) {
+    Vec4 r;
+#if SIMD_MATH_SSE
+    __m128 x = _mm_mul_ps(_mm_load_ps(a.m), _mm_set1_ps(v.x));
+    x = _mm_add_ps(x, _mm_mul_ps(_mm_load_ps(a.m + 4), _mm_set1_ps(v.y)));
+    x = _mm_add_ps(x, _mm_mul_ps(_mm_load_ps(a.m + 8), _mm_set1_ps(v.z)));
+    x = _mm_add_ps(x, _mm_mul_ps(_mm_load_ps(a.m + 12), _mm_set1_ps(v.w)));
+    _mm_store_ps(&r.x, x);
+#elif SIMD_MATH_NEON
+    float32x4_t x = vmulq_n_f32(vld1q_f32(a.m), v.x);
+    x = vmlaq_n_f32(x, vld1q_f32(a.m + 4), v.y);
+    x = vmlaq_n_f32(x, vld1q_f32(a.m + 8), v.z);
+    x = vmlaq_n_f32(x, vld1q_f32(a.m + 12), v.w);
+    vst1q_f32(&r.x, x);
+#else
+    r.x = a.m[0]*v.x + a.m[4]*v.y + a.m[8]*v.z + a.m[12]*v.w;
+    r.y = a.m[1]*v.x + a.m[5]*v.y + a.m[9]*v.z + a.m[13]*v.w;
+    r.z = a.m[2]*v.x + a.m[6]*v.y + a.m[10]*v.z + a.m[14]*v.w;
+    r.w = a.m[3]*v.x + a.m[7]*v.y + a.m[11]*v.z + a.m[15]*v.w;
+#endif
+    return r;
+}
+
+// General inverse by cofactors; scalar, it is needed a few times per frame
+// at most. Returns false and leaves out untouched if a is singular.
+inline bool mat4Inverse(const Mat4& a, Mat4& out) {
+    const float* m = a.m;
+    float inv[16];
+    inv[0] = m[5]*m[10]*m[15] - m[5]*m[11]*m[14] - m[9]*m[6]*m[15] + m[9]*m[7]*m[14] + m[13]*m[6]*m[11] - m[13]*m[7]*m[10];
+    inv[4] = -m[4]*m[10]*m[15] + m[4]*m[11]*m[14] + m[8]*m[6]*m[15] - m[8]*m[7]*m[14] - m[12]*m[6]*m[11] + m[12]*m[7]*m[10];
+    inv[8] = m[4]*m[9]*m[15] - m[4]*m[11]*m[13] - m[8]*m[5]*m[15] + m[8]*m[7]*m[13] + m[12]*m[5]*m[11] - m[12]*m[7]*m[9];
+    inv[12] = -m[4]*m[9]*m[14] + m[4]*m[10]*m[13] + m[8]*m[5]*m[14] - m[8]*m[6]*m[13] - m[12]*m[5]*m[10] + m[12]*m[6]*m[9];
+    inv[1] = -m[1]*m[10]*m[15] + m[1]*m[11]*m[14] + m[9]*m[2]*m[15] - m[9]*m[3]*m[14] - m[13]*m[2]*m[11] + m[13]*m[3]*m[10];
+    inv[5] = m[0]*m[10]*m[15] - m[0]*m[11]*m[14] - m[8]*m[2]*m[15] + m[8]*m[3]*m[14] + m[12]*m[2]*m[11] - m[12]*m[3]*m[10];
+    inv[9] = -m[0]*m[9]*m[15] + m[0]*m[11]*m[13] + m[8]*m[1]*m[15] - m[8]*m[3]*m[13] - m[12]*m[1]*m[11] + m[12]*m[3]*m[9];
+    inv[13] = m[0]*m[9]*m[14] - m[0]*m[10]*m[13] - m[8]*m[1]*m[14] + m[8]*m[2]*m[13] + m[12]*m[1]*m[10] - m[12]*m[2]*m[9];
+    inv[2] = m[1]*m[6]*m[15] - m[1]*m[7]*m[14] - m[5]*m[2]*m[15] + m[5]*m[3]*m[14] + m[13]*m[2]*m[7] - m[13]*m[3]*m[6];
+    inv[6] = -m[0]*m[6]*m[15] + m[0]*m[7]*m[14] + m[4]*m[2]*m[15] - m[4]*m[3]*m[14] - m[12]*m[2]*m[7] + m[12]*m[3]*m[6];
+    inv[10] = m[0]*m[5]*m[15] - m[0]*m[7]*m[13] - m[4]*m[1]*m[15] + m[4]*m[3]*m[13] + m[12]*m[1]*m[7] - m[12]*m[3]*m[5];
+    inv[14] = -m[0]*m[5]*m[14] + m[0]*m[6]*m[13] + m[4]*m[1]*m[14] - m[4]*m[2]*m[13] - m[12]*m[1]*m[6] + m[12]*m[2]*m[5];
+    inv[3] = -m[1]*m[6]*m[11] + m[1]*m[7]*m[10] + m[5]*m[2]*m[11] - m[5]*m[3]*m[10] - m[9]*m[2]*m[7] + m[9]*m[3]*m[6];
+    inv[7] = m[0]*m[6]*m[11] - m[0]*m[7]*m[10] - m[4]*m[2]*m[11] + m[4]*m[3]*m[10] + m[8]*m[2]*m[7] - m[8]*m[3]*m[6];
+    inv[11] = -m[0]*m[5]*m[11] + m[0]*m[7]*m[9] + m[4]*m[1]*m[11] - m[4]*m[3]*m[9] - m[8]*m[1]*m[7] + m[8]*m[3]*m[5];
+    inv[15] = m[0]*m[5]*m[10] - m[0]*m[6]*m[9] - m[4]*m[1]*m[10] + m[4]*m[2]*m[9] + m[8]*m[1]*m[6] - m[8]*m[2]*m[5];
+
+    float det = m[0]*inv[0] + m[1]*inv[4] + m[2]*inv[8] + m[3]*inv[12];
+    if (std::fabs(det) < 1.0e-12f) {
+        return false;
+    }
+    float invDet = 1.0f / det;
+    for (int i = 0; i < 16; i++) {
+        out.m[i] = inv[i] * invDet;
+    }
+    return true;
+}
+
+// Batch transforms
+
+// out[i] = translate(x[i], y[i], z[i]) * scale(s[i]) for n objects
+inline void mat4TranslateScaleBatch(const float* x, const float* y, const float* z, const float* s,
+                                    Mat4* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        float* m = out[i].m;
+#if SIMD_MATH_SSE
+        __m128 scale = _mm_set_ss(s[i]);
+        _mm_store_ps(m, scale);
+        _mm_store_ps(m + 4, _mm_shuffle_ps(scale, scale, _MM_SHUFFLE(1, 1, 0, 1)));
+        _mm_store_ps(m + 8, _mm_shuffle_ps(scale, scale, _MM_SHUFFLE(1, 0, 1, 1)));
+        _mm_store_ps(m + 12, _mm_set_ps(1.0f, z[i], y[i], x[i]));
+#else
+        m[0] = s[i]; m[1] = 0.0f; m[2] = 0.0f; m[3] = 0.0f;
+        m[4] = 0.0f; m[5] = s[i]; m[6] = 0.0f; m[7] = 0.0f;
+        m[8] = 0.0f; m[9] = 0.0f; m[10] = s[i]; m[11] = 0.0f;
+        m[12] = x[i]; m[13] = y[i]; m[14] = z[i]; m[15] = 1.0f;
+#endif
+    }
+}
+
+// out[i] = a * translate(x[i], y[i], z[i]) * scale(s[i]), e.g. view-projection
+// times model for every instance; three column scales and one transform each
+inline void mat4TransformTranslateScaleBatch(const Mat4& a, const float* x, const float* y, const float* z,
+                                             const float* s, Mat4* out, size_t n) {
+#if SIMD_MATH_SSE
+    __m128 a0 = _mm_load_ps(a.m);
+    __m128 a1 = _mm_load_ps(a.m + 4);
+    __m128 a2 = _mm_load_ps(a.m + 8);
+    __m128 a3 = _mm_load_ps(a.m + 12);
+    for (size_t i = 0; i < n; i++) {
+        __m128 scale = _mm_set1_ps(s[i]);
+        float* m = out[i].m;
+        _mm_store_ps(m, _mm_mul_ps(a0, scale));
+        _mm_store_ps(m + 4, _mm_mul_ps(a1, scale));
+        _mm_store_ps(m + 8, _mm_mul_ps(a2, scale));
+        __m128 t = _mm_add_ps(a3, _mm_mul_ps(a0, _mm_set1_ps(x[i])));
+        t = _mm_add_ps(t, _mm_mul_ps(a1, _mm_set1_ps(y[i])));
+        t = _mm_add_ps(t, _mm_mul_ps(a2, _mm_set1_ps(z[i])));
+        _mm_store_ps(m + 12, t);
+    }
+#elif SIMD_MATH_NEON
+    float32x4_t a0 = vld1q_f32(a.m);
+    float32x4_t a1 = vld1q_f32(a.m + 4);
+    float32x4_t a2 = vld1q_f32(a.m + 8);
+    float32x4_t a3 = vld1q_f32(a.m + 12);
+    for (size_t i = 0; i < n; i++) {
+        float* m = out[i].m;
+        vst1q_f32(m, vmulq_n_f32(a0, s[i]));
+        vst1q_f32(m + 4, vmulq_n_f32(a1, s[i]));
+        vst1q_f32(m + 8, vmulq_n_f32(a2, s[i]));
+        float32x4_t t = vmlaq_n_f32(a3, a0, x[i]);
+        t = vmlaq_n_f32(t, a1, y[i]);
+        t = vmlaq_n_f32(t, a2, z[i]);
+        vst1q_f32(m + 12, t);
+    }
+#else
+    for (size_t i = 0; i < n; i++) {
+        float* m = out[i].m;
+        for (int r = 0; r < 4; r++) {
+            m[r] = a.m[r] * s[i];
+            m[4 + r] = a.m[4 + r] * s[i];
+            m[8 + r] = a.m[8 + r] * s[i];
+            m[12 + r] = a.m[r] * x[i] + a.m[4 + r] * y[i] + a.m[8 + r] * z[i] + a.m[12 + r];
+        }
+    }
+#endif
+}
+
+// out[i] = a * b[i]
+inline void mat4MultiplyBatch(const Mat4& a, const Mat4* b, Mat4* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = mat4Multiply(a, b[i]);
+    }
+}
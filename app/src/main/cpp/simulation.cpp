@@ -0,0 +1,141 @@
+#include "simulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+MatchSnapshot captureSnapshot(const Player* players, size_t count, const Ball& ball) {
+    MatchSnapshot snapshot;
+    snapshot.playerCount = static_cast<uint32_t>(std::min<size_t>(count, MAX_PLAYERS));
+    memcpy(snapshot.players, players, snapshot.playerCount * sizeof(Player));
+    snapshot.ball = ball;
+    return snapshot;
+}
+
+Ball kickoffBall() {
+    return {{0.0f, BALL_RADIUS, 0.0f}, {0.0f, 0.0f, 0.0f}, BALL_RADIUS, true};
+}
+
+bool integrateBall(Ball& ball, float dt) {
+    // Update ball physics
+    if (!ball.onGround) {
+        ball.velocity.y += GRAVITY * dt;
+    }
+
+    ball.position.x += ball.velocity.x * dt;
+    ball.position.y += ball.velocity.y * dt;
+    ball.position.z += ball.velocity.z * dt;
+
+    // Ground collision
+    if (ball.position.y < ball.radius) {
+        ball.position.y = ball.radius;
+        ball.velocity.y = -ball.velocity.y * BOUNCE_DAMPING;
+        ball.onGround = (fabs(ball.velocity.y) < 0.1f);
+        if (ball.onGround) {
+            ball.velocity.y = 0.0f;
+        }
+    }
+
+    // Field boundaries collision
+    if (fabs(ball.position.x) > FIELD_WIDTH/2 - ball.radius) {
+        ball.position.x = copysign(FIELD_WIDTH/2 - ball.radius, ball.position.x);
+        ball.velocity.x = -ball.velocity.x * BOUNCE_DAMPING;
+    }
+    bool hitEndLine = false;
+    if (fabs(ball.position.z) > FIELD_HEIGHT/2 - ball.radius) {
+        ball.position.z = copysign(FIELD_HEIGHT/2 - ball.radius, ball.position.z);
+        ball.velocity.z = -ball.velocity.z * BOUNCE_DAMPING;
+        hitEndLine = true;
+    }
+
+    // Friction
+    ball.velocity.x *= FRICTION;
+    ball.velocity.z *= FRICTION;
+    return hitEndLine;
+}
+
+void checkGoal(Ball& ball, bool hitEndLine, StepEvents* events) {
+    if (hitEndLine && fabs(ball.position.x) < GOAL_WIDTH/2 && ball.position.y < GOAL_DEPTH) {
+        if (events) {
+            events->goalSide = ball.position.z > 0.0f ? 1 : -1;
+        }
+        ball = kickoffBall();
+    }
+}
+
+void stepBall(Ball& ball, float dt, StepEvents* events) {
+    bool hitEndLine = integrateBall(ball, dt);
+    checkGoal(ball, hitEndLine, events);
+}
+
+void integratePlayers(Player* players, size_t count, float dt) {
+    for (size_t i = 0; i < count; i++) {
+        Player& player = players[i];
+        float newX = player.position.x + player.velocity.x * dt;
+        float newZ = player.position.z + player.velocity.z * dt;
+        player.position.x = std::clamp(newX, -FIELD_WIDTH/2 + PLAYER_SIZE, FIELD_WIDTH/2 - PLAYER_SIZE);
+        player.position.z = std::clamp(newZ, -FIELD_HEIGHT/2 + PLAYER_SIZE, FIELD_HEIGHT/2 - PLAYER_SIZE);
+    }
+}
+
+void collideBallWithPlayers(Player* players, size_t count, Ball& ball) {
+    for (size_t i = 0; i < count; i++) {
+        Player& player = players[i];
+        float dx = ball.position.x - player.position.x;
+        float dz = ball.position.z - player.position.z;
+        float distance = sqrt(dx*dx + dz*dz);
+        float minDistance = ball.radius + player.size/2;
+
+        if (distance < minDistance && distance > 0.0f) {
+            // Collision response
+            float overlap = minDistance - distance;
+            float nx = dx / distance;
+            float nz = dz / distance;
+
+            // Separate objects
+            ball.position.x += nx * overlap * 0.5f;
+            ball.position.z += nz * overlap * 0.5f;
+            player.position.x -= nx * overlap * 0.5f;
+            player.position.z -= nz * overlap * 0.5f;
+
+            // Transfer momentum
+            float impulseStrength = 5.0f;
+            ball.velocity.x += nx * impulseStrength;
+            ball.velocity.z += nz * impulseStrength;
+
+            // Add some upward force
+            ball.velocity.y += 2.0f;
+            ball.onGround = false;
+        }
+    }
+}
+
+// Simple avoidance: overlapping players are pushed apart evenly
+void separatePlayers(Player* players, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = i + 1; j < count; j++) {
+            float dx = players[i].position.x - players[j].position.x;
+            float dz = players[i].position.z - players[j].position.z;
+            float distance = sqrt(dx*dx + dz*dz);
+            float minDistance = players[i].size;
+
+            if (distance < minDistance && distance > 0.0f) {
+                float overlap = minDistance - distance;
+                float nx = dx / distance;
+                float nz = dz / distance;
+
+                players[i].position.x += nx * overlap * 0.5f;
+                players[i].position.z += nz * overlap * 0.5f;
+                players[j].position.x -= nx * overlap * 0.5f;
+                players[j].position.z -= nz * overlap * 0.5f;
+            }
+        }
+    }
+}
+
+void stepMatch(Player* players, size_t count, Ball& ball, float dt, StepEvents* events) {
+    integratePlayers(players, count, dt);
+    stepBall(ball, dt, events);
+    collideBallWithPlayers(players, count, ball);
+    separatePlayers(players, count);
+}
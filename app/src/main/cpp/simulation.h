@@ -0,0 +1,81 @@
+#pragma once
+
+#include "simd_math.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// Game constants
+constexpr int PLAYERS_PER_TEAM = 11;
+constexpr float FIELD_WIDTH = 20.0f;
+constexpr float FIELD_HEIGHT = 30.0f;
+constexpr float BALL_RADIUS = 0.3f;
+constexpr float PLAYER_SIZE = 0.5f;
+constexpr float GOAL_WIDTH = 5.0f;
+constexpr float GOAL_DEPTH = 2.0f;
+
+// Physics constants
+constexpr float GRAVITY = -9.8f;
+constexpr float FRICTION = 0.98f;
+constexpr float BOUNCE_DAMPING = 0.7f;
+constexpr float PLAYER_SPEED = 8.0f;
+
+// Game objects
+struct Player {
+    Vec3 position;
+    Vec3 velocity;
+    Vec4 color;
+    int team; // 0 = red, 1 = blue
+    float size;
+    bool selected;
+};
+
+struct Ball {
+    Vec3 position;
+    Vec3 velocity;
+    float radius;
+    bool onGround;
+};
+
+constexpr int MAX_PLAYERS = 2 * PLAYERS_PER_TEAM;
+
+// Team 0 attacks the +z goal, team 1 the -z goal
+inline float attackDirection(int team) { return team == 0 ? 1.0f : -1.0f; }
+
+// Compact copy of everything the physics step reads and writes. Plain old
+// data, so cloning a match for lookahead is a single memcpy.
+struct MatchSnapshot {
+    Player players[MAX_PLAYERS];
+    uint32_t playerCount;
+    Ball ball;
+};
+
+struct StepEvents {
+    int goalSide = 0;   // +1 or -1 for the goal the ball entered, 0 if none
+};
+
+MatchSnapshot captureSnapshot(const Player* players, size_t count, const Ball& ball);
+Ball kickoffBall();
+
+// Phases of a step, in the order stepMatch runs them. Exposed so the
+// benchmark can time each one.
+void integratePlayers(Player* players, size_t count, float dt);
+// Gravity, movement, ground and wall bounces and friction; returns whether
+// the ball hit an end line
+bool integrateBall(Ball& ball, float dt);
+// A ball that hit an end line inside the goal mouth scores and restarts
+void checkGoal(Ball& ball, bool hitEndLine, StepEvents* events = nullptr);
+void collideBallWithPlayers(Player* players, size_t count, Ball& ball);
+void separatePlayers(Player* players, size_t count);
+
+// Ball-only part of the step: integrateBall and checkGoal. Player contacts
+// are left to stepMatch.
+void stepBall(Ball& ball, float dt, StepEvents* events = nullptr);
+
+// Advances players and ball by dt. Touches nothing outside its arguments, so
+// it is safe to run on cloned state from any thread.
+void stepMatch(Player* players, size_t count, Ball& ball, float dt, StepEvents* events = nullptr);
+
+inline void stepMatch(MatchSnapshot& snapshot, float dt, StepEvents* events = nullptr) {
+    stepMatch(snapshot.players, snapshot.playerCount, snapshot.ball, dt, events);
+}
@@ -0,0 +1,72 @@
+#include "spatial_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+void SpatialGrid::configure(float minX, float minZ, float maxX, float maxZ, float cellSize) {
+    originX = minX;
+    originZ = minZ;
+    inverseCellSize = 1.0f / cellSize;
+    columns = std::max(1u, static_cast<uint32_t>(std::ceil((maxX - minX) * inverseCellSize)));
+    rows = std::max(1u, static_cast<uint32_t>(std::ceil((maxZ - minZ) * inverseCellSize)));
+    cellStart.assign(static_cast<size_t>(columns) * rows + 1, 0);
+    sortIntoCells();
+}
+
+uint32_t SpatialGrid::column(float px) const {
+    float c = (px - originX) * inverseCellSize;
+    return c <= 0.0f ? 0 : std::min(static_cast<uint32_t>(c), columns - 1);
+}
+
+uint32_t SpatialGrid::row(float pz) const {
+    float r = (pz - originZ) * inverseCellSize;
+    return r <= 0.0f ? 0 : std::min(static_cast<uint32_t>(r), rows - 1);
+}
+
+void SpatialGrid::sortIntoCells() {
+    // Count per cell, prefix sum to each cell's end, then place every object
+    // by walking the ends back down to the starts
+    std::fill(cellStart.begin(), cellStart.end(), 0);
+    for (size_t i = 0; i < x.size(); i++) {
+        cellStart[row(z[i]) * columns + column(x[i]) + 1]++;
+    }
+    for (size_t c = 1; c < cellStart.size(); c++) {
+        cellStart[c] += cellStart[c - 1];
+    }
+    objects.resize(x.size());
+    for (size_t i = x.size(); i-- > 0;) {
+        uint32_t cell = row(z[i]) * columns + column(x[i]);
+        objects[--cellStart[cell + 1]] = static_cast<uint32_t>(i);
+    }
+    // cellStart[c + 1] now holds cell c's start; shift back by one
+    for (size_t c = 0; c + 1 < cellStart.size(); c++) {
+        cellStart[c] = cellStart[c + 1];
+    }
+    cellStart.back() = static_cast<uint32_t>(x.size());
+}
+
+int32_t SpatialGrid::nearest(float px, float pz, float maxDistance) const {
+    uint32_t firstColumn = column(px - maxDistance);
+    uint32_t lastColumn = column(px + maxDistance);
+    uint32_t firstRow = row(pz - maxDistance);
+    uint32_t lastRow = row(pz + maxDistance);
+
+    int32_t best = -1;
+    float bestDistance = maxDistance * maxDistance;
+    for (uint32_t r = firstRow; r <= lastRow; r++) {
+        for (uint32_t c = firstColumn; c <= lastColumn; c++) {
+            uint32_t cell = r * columns + c;
+            for (uint32_t k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+                uint32_t i = objects[k];
+                float dx = x[i] - px;
+                float dz = z[i] - pz;
+                float distance = dx * dx + dz * dz;
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = static_cast<int32_t>(i);
+                }
+            }
+        }
+    }
+    return best;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "simd_math.h"
+
+#include <cstdint>
+#include <vector>
+
+// Uniform grid over the ground (XZ) plane, rebuilt from scratch whenever the
+// objects move: a counting sort into cells, O(n) and allocation-free once
+// the arrays have grown. Queries visit only the cells their radius touches.
+// Objects outside the bounds are kept in the border cells, so nothing is
+// ever lost, only found less cheaply.
+class SpatialGrid {
+public:
+    void configure(float minX, float minZ, float maxX, float maxZ, float cellSize);
+
+    // position(i) returns object i's Vec3; y is ignored
+    template <typename PositionFn>
+    void build(uint32_t count, PositionFn&& position) {
+        x.resize(count);
+        z.resize(count);
+        for (uint32_t i = 0; i < count; i++) {
+            Vec3 p = position(i);
+            x[i] = p.x;
+            z[i] = p.z;
+        }
+        sortIntoCells();
+    }
+
+    // Nearest object within maxDistance of (px, pz), or -1
+    int32_t nearest(float px, float pz, float maxDistance) const;
+
+    uint32_t size() const { return static_cast<uint32_t>(x.size()); }
+
+private:
+    void sortIntoCells();
+    uint32_t column(float px) const;
+    uint32_t row(float pz) const;
+
+    float originX = 0.0f, originZ = 0.0f;
+    float inverseCellSize = 1.0f;
+    uint32_t columns = 1, rows = 1;
+    std::vector<float> x, z;               // Object positions
+    std::vector<uint32_t> cellStart;       // Cell c holds objects[cellStart[c] .. cellStart[c + 1])
+    std::vector<uint32_t> objects;
+};
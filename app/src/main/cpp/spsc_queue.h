@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Lock-free single-producer single-consumer ring buffer of fixed capacity
+// (a power of two). push() fails instead of blocking when the ring is full.
+// Each side keeps a cached copy of the other's index and only reloads the
+// shared atomic when the cache says full or empty, so in the common case a
+// push or pop touches no cache line the other thread writes.
+//
+// Used to hand timestamped input events from the platform's event callbacks
+// to the simulation, which drains them at tick boundaries.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    // Producer side
+    bool push(const T& value) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead == Capacity) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead == Capacity) {
+                return false;
+            }
+        }
+        slots[t & MASK] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. peek() returns the oldest value without removing it, or
+    // null if the queue is empty; it stays valid until pop().
+    const T* peek() {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) {
+                return nullptr;
+            }
+        }
+        return &slots[h & MASK];
+    }
+
+    bool pop(T& value) {
+        const T* front = peek();
+        if (!front) {
+            return false;
+        }
+        value = *front;
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    static constexpr uint32_t MASK = static_cast<uint32_t>(Capacity - 1);
+
+    T slots[Capacity] = {};
+    alignas(64) std::atomic<uint32_t> tail{0};   // Written by the producer
+    uint32_t cachedHead = 0;                     // Producer only
+    alignas(64) std::atomic<uint32_t> head{0};   // Written by the consumer
+    uint32_t cachedTail = 0;                     // Consumer only
+};
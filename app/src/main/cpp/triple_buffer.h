@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-producer single-consumer triple buffer. The producer
+// fills writeBuffer() and publishes it; the consumer picks up the newest
+// published value with update() and reads it until the next update. Neither
+// side ever waits: the producer always has a free slot, and a value the
+// consumer skipped is simply overwritten.
+//
+// Used to hand immutable simulation snapshots to the render thread, so a
+// physics step and a frame's command recording run at the same time.
+template <typename T>
+class TripleBuffer {
+public:
+    // Producer side
+    T& writeBuffer() { return buffers[writeIndex]; }
+
+    void publish() {
+        uint8_t previous = middle.exchange(writeIndex | FRESH, std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+    // Consumer side. Returns whether a newer value than the current read()
+    // arrived.
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) {
+            return false;
+        }
+        uint8_t previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    const T& read() const { return buffers[readIndex]; }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH = 0x4;   // The middle slot holds an unread value
+
+    T buffers[3] = {};
+    uint8_t writeIndex = 0;                      // Producer only
+    alignas(64) std::atomic<uint8_t> middle{2};  // Slot being handed over
+    alignas(64) uint8_t readIndex = 1;           // Consumer only
+};